@@ -0,0 +1,37 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "AllocationCounter.h"
+
+namespace {
+    std::atomic_size_t g_allocations{0}; /**< Allocations made by every thread. */
+    thread_local std::size_t g_threadAllocations = 0; /**< Allocations made by the calling thread. */
+} // namespace
+
+namespace utils {
+    std::size_t CountAllocations() noexcept { return g_allocations.load(std::memory_order_relaxed); }
+
+    std::size_t CountThreadAllocations() noexcept { return g_threadAllocations; }
+} // namespace utils
+
+// The array forms forward to these by default, and the aligned forms keep the library's own matching pair.
+void *operator new(const std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    ++g_threadAllocations;
+    if (void *p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+// GCC sees free called on what it takes for operator new memory, but the replacement above allocates with malloc.
+#ifdef __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+#ifdef __GNUC__
+#pragma GCC diagnostic pop
+#endif
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+ * Heap allocation counts for the tests and benchmarks. Linking AllocationCounter.cpp replaces the global operator new
+ * with one that counts every call, so only the test-support library carries it.
+ */
+namespace utils {
+    /**
+     * @brief Gets the number of heap allocations made by every thread so far.
+     * @return Allocation count; take the difference of two calls to count the allocations in between.
+     */
+    std::size_t CountAllocations() noexcept;
+    /**
+     * @brief Gets the number of heap allocations made by the calling thread so far.
+     * @return Allocation count; take the difference of two calls to count the allocations in between.
+     */
+    std::size_t CountThreadAllocations() noexcept;
+} // namespace utils
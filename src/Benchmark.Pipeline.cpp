@@ -0,0 +1,551 @@
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "AllocationCounter.h"
+#include "Config.h"
+#include "aff/Parser.h"
+#include "mgxc/ComChartWriter.h"
+#include "mgxc/Easing.h"
+#include "mgxc/Interpolator.h"
+#include "mgxc/MockMargrete.h"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+    using Nanoseconds = std::chrono::duration<double, std::nano>;
+
+    constexpr std::string_view USAGE = R"(Usage: pipeline-benchmark [options]
+
+Times each stage of the parse, convert and commit pipeline on synthetic charts.
+
+Options:
+  --filter <text>     Run only benchmarks whose name contains <text>
+  --format <fmt>      Output format on stdout: console (default) or json
+  --out <file>        Also write the results as JSON to <file>
+  --min-time <s>      Minimum time to measure each benchmark for (default: 0.5)
+  --threads <n>       Worker threads for parsing and conversion, or 0 for all (default: 1)
+  --com-latency <ns>  Simulated time of every chart interface call during commit (default: 0)
+  --tolerance <d>     Simplification tolerance of the conversion, in lanes and height units (default: 0, off)
+  --arcs <n>          Benchmark a single chart with <n> arcs instead of the default set
+  --length <n>        Arcs per chain of that chart (default: 8)
+  --easings <list>    Comma-separated arc easings of that chart, used in turn (default: all)
+  --groups <n>        Timing groups of that chart (default: 1)
+  -h, --help          Show this help
+)";
+
+    /** Every arc easing of the .aff format. */
+    constexpr std::string_view ALL_EASINGS = "s,b,si,so,sisi,soso,siso,sosi";
+
+    /**
+     * @struct ChartSpec
+     * @brief Shape of a synthetic chart.
+     */
+    struct ChartSpec {
+        std::size_t arcs{10'000}; /**< Number of arcs. */
+        int length{8}; /**< Number of arcs per chain. */
+        std::string easings{ALL_EASINGS}; /**< Comma-separated arc easings, used in turn. */
+        int groups{1}; /**< Number of timing groups the chains are spread over. */
+
+        /**
+         * @brief Gets the name of the chart, as used in benchmark names.
+         * @return The name.
+         */
+        std::string Name() const {
+            return std::format("arcs:{}/length:{}/easings:{}/groups:{}", arcs, length,
+                               easings == ALL_EASINGS ? "all" : easings, groups);
+        }
+    };
+
+    /**
+     * @struct Options
+     * @brief Options read from the command line.
+     */
+    struct Options {
+        std::string filter; /**< Substring of the benchmarks to run. */
+        bool json{false}; /**< If true, print JSON instead of a table. */
+        std::string out; /**< File receiving JSON results, or empty. */
+        double minTime{0.5}; /**< Minimum measuring time per benchmark, in seconds. */
+        unsigned threads{1}; /**< Worker threads for parsing and conversion. */
+        std::chrono::nanoseconds comLatency{0}; /**< Simulated time of every chart interface call. */
+        double tolerance{0}; /**< Simplification tolerance of the conversion. */
+        std::vector<ChartSpec> charts; /**< Charts to benchmark. */
+        bool help{false}; /**< If true, show the usage and exit. */
+    };
+
+    /**
+     * @struct Result
+     * @brief Timing statistics of a benchmark.
+     */
+    struct Result {
+        std::string name; /**< Stage and chart name. */
+        ChartSpec chart; /**< The chart measured. */
+        std::size_t iterations{0}; /**< Number of timed runs. */
+        double mean{0}; /**< Mean time per run in nanoseconds. */
+        double median{0}; /**< Median time per run in nanoseconds. */
+        double min{0}; /**< Fastest run in nanoseconds. */
+        double stddev{0}; /**< Standard deviation of the runs in nanoseconds. */
+        std::size_t items{0}; /**< Items processed per run: arcs for parse stages, notes afterwards. */
+        std::size_t comCalls{0}; /**< Chart interface calls per run, for commit. */
+        std::optional<double> allocations{}; /**< Heap allocations per run, for convert. */
+    };
+
+    /**
+     * @brief Generates .aff text for a chart spec.
+     *
+     * Chains are interleaved the way charts list arcs, by start time, and every arc ends where the next arc of its
+     * chain starts, so the linker rebuilds exactly the generated chains.
+     *
+     * @param spec Shape of the chart.
+     * @return Chart text.
+     */
+    std::string MakeChart(const ChartSpec &spec) {
+        std::vector<std::string_view> easings;
+        for (const auto part: std::views::split(std::string_view(spec.easings), ',')) {
+            easings.emplace_back(part.begin(), part.end());
+        }
+
+        const std::size_t chains = (spec.arcs + spec.length - 1) / spec.length;
+        const std::size_t groups = std::max(1, spec.groups);
+        const std::size_t perGroup = (chains + groups - 1) / groups;
+
+        // Arcs of one step start 5 ms apart, so no two arcs ever share a start point.
+        const auto position = [](const std::size_t chain, const int step) {
+            return std::pair((chain * 3 + step * 7) % 11 * 0.1, (chain * 5 + step * 3) % 11 * 0.1);
+        };
+
+        std::string text = "AudioOffset:0\n-\ntiming(0,100.00,4.00);\n";
+        text.reserve(spec.arcs * 64 + groups * 48);
+        std::size_t arc = 0;
+        for (std::size_t g = 0; g < groups; ++g) {
+            const std::size_t first = g * perGroup;
+            const std::size_t last = std::min(chains, first + perGroup);
+            if (g > 0) {
+                text += "timinggroup(){\ntiming(0,100.00,4.00);\n";
+            }
+
+            const int span = static_cast<int>(last - first) * 5;
+            for (int step = 0; step < spec.length; ++step) {
+                for (std::size_t c = first; c < last && arc < spec.arcs; ++c, ++arc) {
+                    const int t = step * span + static_cast<int>(c - first) * 5;
+                    const auto [x, y] = position(c, step);
+                    const auto [toX, toY] = position(c, step + 1);
+                    std::format_to(std::back_inserter(text), "arc({},{},{:.2f},{:.2f},{},{:.2f},{:.2f},{},none,{});\n",
+                                   t, t + span, x, toX, easings[arc % easings.size()], y, toY, c % 2,
+                                   c % 3 == 0 ? "true" : "false");
+                }
+            }
+
+            if (g > 0) {
+                text += "};\n";
+            }
+        }
+        return text;
+    }
+
+    /**
+     * @brief Runs a function repeatedly, after one warm-up run, until the minimum time has passed.
+     * @tparam F Callable returning the time of one run.
+     * @param minTime Minimum measuring time in seconds.
+     * @param run The function to run.
+     */
+    template<class F>
+    std::vector<double> Measure(const double minTime, F &&run) {
+        run();
+
+        std::vector<double> samples;
+        double total = 0;
+        while (total < minTime * 1e9 && samples.size() < 1'000'000) {
+            samples.push_back(Nanoseconds(run()).count());
+            total += samples.back();
+        }
+        return samples;
+    }
+
+    /**
+     * @brief Computes the statistics of a benchmark.
+     * @param name Name of the benchmark.
+     * @param chart The chart measured.
+     * @param samples Time of every run in nanoseconds.
+     * @param items Items processed per run.
+     * @return The statistics.
+     */
+    Result Summarize(std::string name, const ChartSpec &chart, std::vector<double> samples, const std::size_t items) {
+        Result result{std::move(name), chart, samples.size()};
+        result.items = items;
+        if (samples.empty()) {
+            return result;
+        }
+
+        std::ranges::sort(samples);
+        const double n = static_cast<double>(samples.size());
+        double sum = 0;
+        for (const double s: samples) {
+            sum += s;
+        }
+        result.mean = sum / n;
+        result.min = samples.front();
+        result.median = samples.size() % 2 ? samples[samples.size() / 2]
+                                           : (samples[samples.size() / 2 - 1] + samples[samples.size() / 2]) / 2;
+
+        double squares = 0;
+        for (const double s: samples) {
+            squares += (s - result.mean) * (s - result.mean);
+        }
+        result.stddev = samples.size() > 1 ? std::sqrt(squares / (n - 1)) : 0.0;
+        return result;
+    }
+
+    /**
+     * @brief Benchmarks every pipeline stage on a chart.
+     *
+     * The parser reports the time of each of its stages, so a single timed parse yields the tokenize, link and
+     * append samples together.
+     *
+     * @param spec The chart.
+     * @param opts The options.
+     * @param results Receives the results of the stages that match the filter.
+     */
+    void RunChart(const ChartSpec &spec, const Options &opts, std::vector<Result> &results) {
+        const std::string chart = spec.Name();
+        const auto selected = [&](const std::string_view stage) {
+            return std::format("{}/{}", stage, chart).find(opts.filter) != std::string::npos;
+        };
+        constexpr std::string_view parseStages[] = {"Tokenize", "Link", "AppendChainsToConfig"};
+        constexpr std::string_view convertStages[] = {"Convert", "Commit"};
+        if (std::ranges::none_of(parseStages, selected) && std::ranges::none_of(convertStages, selected)) {
+            return;
+        }
+
+        const std::string text = MakeChart(spec);
+        Config cctx;
+        cctx.threads = opts.threads;
+        cctx.tolerance = opts.tolerance;
+        aff::Parser parser(cctx);
+
+        std::vector<double> tokenize;
+        std::vector<double> link;
+        std::vector<double> append;
+        const std::vector<double> parse = Measure(opts.minTime, [&] {
+            parser.Parse(text);
+            const aff::ParseStages &stages = parser.GetStages();
+            tokenize.push_back(Nanoseconds(stages.tokenize).count());
+            link.push_back(Nanoseconds(stages.link).count());
+            append.push_back(Nanoseconds(stages.append).count());
+            return stages.Total();
+        });
+        // Drop the warm-up run, which Measure does not time either.
+        for (std::vector<double> *samples: {&tokenize, &link, &append}) {
+            samples->erase(samples->begin());
+        }
+
+        const std::vector<double> *parseSamples[] = {&tokenize, &link, &append};
+        for (std::size_t i = 0; i < std::size(parseStages); ++i) {
+            if (selected(parseStages[i])) {
+                results.push_back(Summarize(std::format("{}/{}", parseStages[i], chart), spec, *parseSamples[i],
+                                            spec.arcs));
+            }
+        }
+
+        Interpolator interpolator(cctx);
+        interpolator.Convert();
+        std::size_t notes = 0;
+        for (const std::vector<MP_NOTEINFO> &noteChain: interpolator.GetNoteChains()) {
+            notes += noteChain.size();
+        }
+
+        if (selected("Convert")) {
+            // The interpolator is reused across runs as the plugin's session is, so this counts the steady state.
+            std::size_t allocations = 0;
+            std::vector<double> samples = Measure(opts.minTime, [&] {
+                const std::size_t before = utils::CountAllocations();
+                const auto start = Clock::now();
+                interpolator.Convert();
+                const auto elapsed = Clock::now() - start;
+                allocations += utils::CountAllocations() - before;
+                return elapsed;
+            });
+
+            Result result = Summarize(std::format("Convert/{}", chart), spec, std::move(samples), notes);
+            // Counted over the warm-up run too, which Measure makes before the timed ones.
+            result.allocations = static_cast<double>(allocations) / static_cast<double>(result.iterations + 1);
+            results.push_back(std::move(result));
+        }
+
+        if (selected("Commit")) {
+            mgxc::mock::Margrete mg(opts.comLatency);
+            mgxc::ComChartWriter writer(mg);
+            std::vector<double> samples = Measure(opts.minTime, [&] {
+                mg.Reset();
+                const auto start = Clock::now();
+                interpolator.Commit(writer);
+                return Clock::now() - start;
+            });
+            if (mg.GetCalls().setInfo != mg.GetChartState().CountNotes()) {
+                throw std::logic_error("Mock chart lost notes during commit");
+            }
+
+            Result result = Summarize(std::format("Commit/{}", chart), spec, std::move(samples), notes);
+            result.comCalls = mg.GetCalls().Total();
+            results.push_back(std::move(result));
+        }
+    }
+
+    /**
+     * @brief Formats a time with a unit that keeps it readable.
+     * @param ns Time in nanoseconds.
+     * @return The formatted time.
+     */
+    std::string FormatTime(const double ns) {
+        if (ns >= 1e9) {
+            return std::format("{:.2f} s", ns / 1e9);
+        }
+        if (ns >= 1e6) {
+            return std::format("{:.2f} ms", ns / 1e6);
+        }
+        if (ns >= 1e3) {
+            return std::format("{:.2f} us", ns / 1e3);
+        }
+        return std::format("{:.0f} ns", ns);
+    }
+
+    /**
+     * @brief Gets the throughput of a benchmark.
+     * @param result The benchmark.
+     * @return Items per second.
+     */
+    double ItemsPerSecond(const Result &result) {
+        return result.mean > 0 ? static_cast<double>(result.items) * 1e9 / result.mean : 0.0;
+    }
+
+    /**
+     * @brief Prints results as a table.
+     * @param out Stream to print to.
+     * @param results The results.
+     */
+    void WriteConsole(std::ostream &out, const std::span<const Result> results) {
+        std::size_t width = std::string_view("Benchmark").size();
+        for (const Result &r: results) {
+            width = std::max(width, r.name.size());
+        }
+
+        out << std::format("{:<{}}  {:>12}  {:>12}  {:>10}  {:>10}  {:>14}  {:>12}\n", "Benchmark", width, "Mean",
+                           "Median", "Stddev", "Iterations", "Items/s", "Allocs/iter");
+        out << std::string(width + 84, '-') << '\n';
+        for (const Result &r: results) {
+            out << std::format("{:<{}}  {:>12}  {:>12}  {:>9.1f}%  {:>10}  {:>13.3g}  {:>12}\n", r.name, width,
+                               FormatTime(r.mean), FormatTime(r.median), r.mean > 0 ? r.stddev / r.mean * 100 : 0.0,
+                               r.iterations, ItemsPerSecond(r),
+                               r.allocations ? std::format("{:.1f}", *r.allocations) : std::string("-"));
+        }
+    }
+
+    /**
+     * @brief Escapes a string for a JSON string literal.
+     * @param text The string.
+     * @return The escaped string, without quotes.
+     */
+    std::string EscapeJson(const std::string_view text) {
+        std::string escaped;
+        for (const char c: text) {
+            if (c == '"' || c == '\\') {
+                escaped += '\\';
+            }
+            escaped += c;
+        }
+        return escaped;
+    }
+
+    /**
+     * @brief Writes results as JSON, in the layout of Google Benchmark's JSON output.
+     * @param out Stream to write to.
+     * @param results The results.
+     * @param opts The options.
+     */
+    void WriteJson(std::ostream &out, const std::span<const Result> results, const Options &opts) {
+#ifdef NDEBUG
+        constexpr std::string_view buildType = "release";
+#else
+        constexpr std::string_view buildType = "debug";
+#endif
+        out << "{\n  \"context\": {\n";
+        out << std::format("    \"date\": \"{:%FT%TZ}\",\n",
+                           std::chrono::floor<std::chrono::seconds>(std::chrono::system_clock::now()));
+        out << std::format("    \"num_cpus\": {},\n", std::thread::hardware_concurrency());
+        out << std::format("    \"threads\": {},\n", opts.threads);
+        out << std::format("    \"batch_kernel\": \"{}\",\n", Easing::GetBatchKernel());
+        out << std::format("    \"library_build_type\": \"{}\"\n", buildType);
+        out << "  },\n  \"benchmarks\": [\n";
+        for (const Result &r: results) {
+            out << "    {\n";
+            out << std::format("      \"name\": \"{}\",\n", EscapeJson(r.name));
+            out << std::format("      \"arcs\": {},\n", r.chart.arcs);
+            out << std::format("      \"length\": {},\n", r.chart.length);
+            out << std::format("      \"easings\": \"{}\",\n", EscapeJson(r.chart.easings));
+            out << std::format("      \"groups\": {},\n", r.chart.groups);
+            out << std::format("      \"iterations\": {},\n", r.iterations);
+            out << std::format("      \"real_time\": {:.1f},\n", r.mean);
+            out << std::format("      \"median_time\": {:.1f},\n", r.median);
+            out << std::format("      \"min_time\": {:.1f},\n", r.min);
+            out << std::format("      \"stddev_time\": {:.1f},\n", r.stddev);
+            out << "      \"time_unit\": \"ns\",\n";
+            if (r.comCalls > 0) {
+                out << std::format("      \"com_calls\": {},\n", r.comCalls);
+                out << std::format("      \"com_calls_per_note\": {:.3f},\n",
+                                   static_cast<double>(r.comCalls) / static_cast<double>(r.items));
+            }
+            if (r.allocations) {
+                out << std::format("      \"allocations_per_iteration\": {:.3f},\n", *r.allocations);
+            }
+            out << std::format("      \"items_per_second\": {:.1f}\n", ItemsPerSecond(r));
+            out << (&r == &results.back() ? "    }\n" : "    },\n");
+        }
+        out << "  ]\n}\n";
+    }
+
+    /**
+     * @brief Parses the value of a numeric option.
+     * @tparam T Numeric type of the value.
+     * @param option Name of the option.
+     * @param value Text of the value.
+     * @return The value.
+     * @throws std::invalid_argument if the value is not a non-negative number.
+     */
+    template<class T>
+    T ParseNumber(const std::string_view option, const std::string_view value) {
+        T result{};
+        const auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), result);
+        if (ec != std::errc{} || end != value.data() + value.size() || result < T{}) {
+            throw std::invalid_argument(std::format("Invalid value for {}: '{}'", option, value));
+        }
+        return result;
+    }
+
+    /**
+     * @brief Reads the options from the command line.
+     * @param args Arguments, without the program name.
+     * @return The options.
+     * @throws std::invalid_argument if an option is unknown or lacks its value.
+     */
+    Options ParseArgs(const std::span<char *const> args) {
+        Options opts;
+        ChartSpec custom;
+        bool hasCustom = false;
+
+        for (std::size_t i = 0; i < args.size(); ++i) {
+            const std::string_view arg = args[i];
+            const auto value = [&]() -> std::string_view {
+                if (i + 1 >= args.size()) {
+                    throw std::invalid_argument(std::format("Missing value for {}", arg));
+                }
+                return args[++i];
+            };
+
+            if (arg == "-h" || arg == "--help") {
+                opts.help = true;
+            } else if (arg == "--filter") {
+                opts.filter = value();
+            } else if (arg == "--format") {
+                const std::string_view format = value();
+                if (format != "console" && format != "json") {
+                    throw std::invalid_argument(std::format("Unknown format: {}", format));
+                }
+                opts.json = format == "json";
+            } else if (arg == "--out") {
+                opts.out = value();
+            } else if (arg == "--min-time") {
+                opts.minTime = ParseNumber<double>(arg, value());
+            } else if (arg == "--threads") {
+                opts.threads = ParseNumber<unsigned>(arg, value());
+            } else if (arg == "--com-latency") {
+                opts.comLatency = std::chrono::nanoseconds(ParseNumber<std::int64_t>(arg, value()));
+            } else if (arg == "--tolerance") {
+                opts.tolerance = ParseNumber<double>(arg, value());
+            } else if (arg == "--arcs") {
+                custom.arcs = std::max<std::size_t>(1, ParseNumber<std::size_t>(arg, value()));
+                hasCustom = true;
+            } else if (arg == "--length") {
+                custom.length = std::max(1, ParseNumber<int>(arg, value()));
+                hasCustom = true;
+            } else if (arg == "--easings") {
+                custom.easings = value();
+                hasCustom = true;
+            } else if (arg == "--groups") {
+                custom.groups = std::max(1, ParseNumber<int>(arg, value()));
+                hasCustom = true;
+            } else {
+                throw std::invalid_argument(std::format("Unknown option: {}", arg));
+            }
+        }
+
+        if (hasCustom) {
+            opts.charts = {custom};
+        } else {
+            const std::string all{ALL_EASINGS};
+            opts.charts = {
+                    {1'000, 8, all, 1},   {10'000, 8, all, 1},   {100'000, 8, all, 1}, {10'000, 64, all, 1},
+                    {10'000, 8, "s", 1},  {10'000, 8, "b", 1},   {10'000, 8, all, 8},
+            };
+        }
+        return opts;
+    }
+} // namespace
+
+int main(const int argc, char *argv[]) {
+    Options opts;
+    try {
+        opts = ParseArgs(std::span(argv + 1, argv + argc));
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << "\n\n" << USAGE;
+        return 2;
+    }
+
+    if (opts.help) {
+        std::cout << USAGE;
+        return 0;
+    }
+
+    std::vector<Result> results;
+    try {
+        for (const ChartSpec &chart: opts.charts) {
+            RunChart(chart, opts, results);
+            if (!opts.json && !results.empty()) {
+                std::cerr << std::format("Done {}\n", chart.Name());
+            }
+        }
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+    if (opts.json) {
+        WriteJson(std::cout, results, opts);
+    } else {
+        WriteConsole(std::cout, results);
+    }
+
+    if (!opts.out.empty()) {
+        std::ofstream out(opts.out);
+        WriteJson(out, results, opts);
+        if (!out) {
+            std::cerr << std::format("Failed to write {}\n", opts.out);
+            return 1;
+        }
+    }
+    return 0;
+}
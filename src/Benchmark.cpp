@@ -0,0 +1,527 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <algorithm>
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Config.h"
+#include "MappedFile.h"
+#include "aff/Arc.h"
+#include "aff/Linker.h"
+#include "aff/Timing.h"
+#include "aff/Tokenizer.h"
+#include "mgxc/ChainBinary.h"
+#include "mgxc/EasingTable.h"
+#include "mgxc/Interpolator.h"
+
+namespace {
+    /**
+     * @brief Generates arcs forming interleaved chains, in the order a chart would list them.
+     * @param count Number of arcs.
+     * @param length Number of arcs per chain.
+     * @return Synthetic arcs sorted by start time.
+     */
+    std::vector<aff::Arc> MakeArcs(const std::size_t count, const int length) {
+        const std::size_t chains = (count + length - 1) / length;
+
+        std::vector<aff::Arc> arcs;
+        arcs.reserve(count);
+        for (int step = 0; step < length; ++step) {
+            for (std::size_t c = 0; c < chains && arcs.size() < count; ++c) {
+                aff::Arc arc;
+                arc.t = static_cast<int>(c) * 7 + step * 100;
+                arc.toT = arc.t + 100;
+                arc.x = static_cast<int>(c % 16) + step;
+                arc.toX = arc.x + 1;
+                arc.y = static_cast<int>(c / 16 % 100) + step;
+                arc.toY = arc.y + 1;
+                arc.type = static_cast<int>(c % 2);
+                arcs.push_back(arc);
+            }
+        }
+        return arcs;
+    }
+
+    /**
+     * @brief Generates .aff text of roughly the given size.
+     * @param bytes Minimum size of the text.
+     * @return Synthetic chart text.
+     */
+    std::string MakeAff(const std::size_t bytes) {
+        std::string text = "AudioOffset:0\n-\ntiming(0,100.00,4.00);\n";
+        text.reserve(bytes + 128);
+        for (int i = 0; text.size() < bytes; ++i) {
+            const int t = i * 50;
+            std::format_to(std::back_inserter(text), "arc({},{},{:.2f},{:.2f},sisi,{:.2f},{:.2f},{},none,{});\n", t,
+                           t + 50, i % 10 * 0.1, (i + 1) % 10 * 0.1, i % 7 * 0.2, (i + 1) % 7 * 0.2, i % 2,
+                           i % 3 == 0 ? "true" : "false");
+        }
+        return text;
+    }
+
+    /**
+     * @brief Counts the statements in a buffer, touching every byte of it.
+     * @param text The buffer to tokenize.
+     * @return Number of statements.
+     */
+    std::size_t CountStatements(const std::string_view text) {
+        aff::Tokenizer tokenizer(text);
+        aff::Event event;
+
+        std::size_t count = 0;
+        while (tokenizer.Next(event)) {
+            ++count;
+        }
+        return count;
+    }
+
+    /**
+     * @brief Reads a whole file through a stream, as the parser did before files were mapped.
+     * @param filePath Path to the file.
+     * @return Number of statements in the file.
+     */
+    std::size_t ReadStreamed(const std::string &filePath) {
+        std::ifstream file(filePath, std::ios::binary);
+        const std::string content((std::istreambuf_iterator(file)), (std::istreambuf_iterator<char>()));
+        return CountStatements(content);
+    }
+
+    /**
+     * @brief Reads a whole file through a read-only mapping.
+     * @param filePath Path to the file.
+     * @return Number of statements in the file.
+     */
+    std::size_t ReadMapped(const std::string &filePath) {
+        utils::MappedFile file;
+        REQUIRE(file.Open(filePath));
+        return CountStatements(file.View());
+    }
+
+    /**
+     * @brief Generates chains with random positions and easings, as a large import would produce.
+     * @param count Number of chains.
+     * @param length Number of joints per chain.
+     * @return Synthetic chains.
+     */
+    std::vector<mgxc::Chain> MakeChains(const std::size_t count, const int length) {
+        std::mt19937 rng(1);
+        const auto random = [&rng](const int lo, const int hi) { return std::uniform_int_distribution(lo, hi)(rng); };
+        constexpr EasingMode modes[] = {EasingMode::Linear, EasingMode::In, EasingMode::Out};
+
+        std::vector<mgxc::Chain> chains(count);
+        for (mgxc::Chain &chain: chains) {
+            chain.es = {static_cast<EasingKind>("spc"[random(0, 2)]), static_cast<double>(random(1, 3))};
+            if (chain.es.m_kind == EasingKind::Circular) {
+                chain.es.m_param = random(0, 4) / 4.0;
+            }
+
+            int t = random(0, 1000) * 5;
+            for (int i = 0; i < length; ++i) {
+                chain.emplace_back(t, random(0, 15), random(0, 360), modes[random(0, 2)], modes[random(0, 2)]);
+                t += random(1, 100) * 5;
+            }
+        }
+        return chains;
+    }
+
+    /**
+     * @struct IdJoint
+     * @brief Joint as it was laid out with a unique ID, taken from a shared counter on every construction.
+     */
+    struct IdJoint {
+        inline static std::atomic_size_t nextId{0};
+        MpInteger t{0}, x{0}, y{80};
+        EasingMode eX{EasingMode::Linear}, eY{EasingMode::Linear};
+        std::size_t id{nextId++};
+
+        IdJoint Snap(const MpInteger snap) const {
+            return IdJoint{utils::iround(static_cast<double>(t) / snap), x, y, eX, eY};
+        }
+    };
+
+#ifdef __linux__
+    /**
+     * @brief Resets the peak resident set size of this process.
+     */
+    void ResetPeakRss() { std::ofstream("/proc/self/clear_refs") << "5"; }
+
+    /**
+     * @brief Reads the peak resident set size of this process.
+     * @return Peak RSS in KiB.
+     */
+    std::size_t PeakRssKiB() {
+        std::ifstream status("/proc/self/status");
+        for (std::string line; std::getline(status, line);) {
+            if (line.starts_with("VmHWM:")) {
+                return std::stoull(line.substr(6));
+            }
+        }
+        return 0;
+    }
+#endif
+} // namespace
+
+/**
+ * @test Links synthetic charts from 1k to 1M arcs to show how chain building scales.
+ */
+TEST_CASE("Link Scaling", "[benchmark][link]") {
+    for (const std::size_t count: {1'000u, 10'000u, 100'000u, 1'000'000u}) {
+        const std::vector<aff::Arc> arcs = MakeArcs(count, 8);
+
+        BENCHMARK(std::format("Link {} arcs", count)) { return aff::Linker(arcs).Link(); };
+    }
+}
+
+/**
+ * @test Tokenizes a 50 MB synthetic chart and decodes every arc's numbers in place.
+ */
+TEST_CASE("Tokenize 50 MB", "[benchmark][tokenize]") {
+    const std::string text = MakeAff(50u << 20);
+
+    BENCHMARK("Tokenize 50 MB") {
+        aff::Tokenizer tokenizer(text);
+        aff::Event event;
+
+        std::size_t arcs = 0;
+        while (tokenizer.Next(event)) {
+            if (event.kind == aff::Event::Kind::Call && event.name == "arc" && event.argc == 10) {
+                int t, toT;
+                double x, toX, y, toY;
+                arcs += aff::ToInt(event.args[0], t) && aff::ToInt(event.args[1], toT) &&
+                        aff::ToDouble(event.args[2], x) && aff::ToDouble(event.args[3], toX) &&
+                        aff::ToDouble(event.args[5], y) && aff::ToDouble(event.args[6], toY);
+            }
+        }
+        return arcs;
+    };
+}
+
+/**
+ * @test Compares wall time and peak RSS of mapped and streamed input on a large concatenated chart.
+ */
+TEST_CASE("Read Large File", "[benchmark][file]") {
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "aircurve-bench-large.aff";
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << MakeAff(128u << 20);
+    }
+    const std::string filePath = path.string();
+
+    REQUIRE(ReadMapped(filePath) == ReadStreamed(filePath));
+
+#ifdef __linux__
+    const auto measure = [&filePath](const auto &read) {
+        ResetPeakRss();
+        const std::size_t baseline = PeakRssKiB();
+        read(filePath);
+        return PeakRssKiB() - baseline;
+    };
+
+    const std::size_t streamed = measure(ReadStreamed);
+    const std::size_t mapped = measure(ReadMapped);
+
+    std::cout << std::format("Peak RSS over baseline: streamed {} KiB, mapped {} KiB\n", streamed, mapped);
+#endif
+
+    BENCHMARK("Read 128 MB streamed") { return ReadStreamed(filePath); };
+    BENCHMARK("Read 128 MB mapped") { return ReadMapped(filePath); };
+
+    std::filesystem::remove(path);
+}
+
+/**
+ * @test Saves and loads 100k chains of 16 joints as text and in the binary chain format, in memory and from a file.
+ */
+TEST_CASE("Chain Interchange", "[benchmark][file]") {
+    const std::vector<mgxc::Chain> chains = MakeChains(100'000, 16);
+    const std::string text = mgxc::data::Serialize(chains);
+    const std::string binary = mgxc::data::SerializeBinary(chains);
+    REQUIRE(mgxc::data::Serialize(mgxc::data::ParseBinary(binary)) == text);
+    std::cout << std::format("Text {:.1f} MiB, binary {:.1f} MiB\n", static_cast<double>(text.size()) / (1 << 20),
+                             static_cast<double>(binary.size()) / (1 << 20));
+
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "aircurve-bench-chains.mgxb";
+    {
+        std::ofstream out(path, std::ios::binary);
+        out.write(binary.data(), static_cast<std::streamsize>(binary.size()));
+    }
+    const std::string filePath = path.string();
+
+    BENCHMARK("Save 100k chains, text") { return mgxc::data::Serialize(chains).size(); };
+    BENCHMARK("Save 100k chains, binary") { return mgxc::data::SerializeBinary(chains).size(); };
+    BENCHMARK("Load 100k chains, text") { return mgxc::data::Parse(text).size(); };
+    BENCHMARK("Load 100k chains, binary") { return mgxc::data::ParseBinary(binary).size(); };
+    BENCHMARK("Load 100k chains, binary mapped file") { return mgxc::data::LoadBinary(filePath).size(); };
+
+    std::filesystem::remove(path);
+}
+
+/**
+ * @test Converts arc times on a chart with thousands of tempo changes.
+ */
+TEST_CASE("Tempo Map", "[benchmark][timing]") {
+    constexpr int changes = 5'000;
+    constexpr int times = 1'000'000;
+
+    aff::TimingMap timing(480);
+    for (int i = 0; i < changes; ++i) {
+        timing.Add(i * 200, 60.0 + i % 180);
+    }
+    timing.Build();
+
+    std::vector<int> ms(times);
+    for (int i = 0; i < times; ++i) {
+        ms[i] = static_cast<int>(static_cast<long long>(i) * changes * 200 / times);
+    }
+    std::vector<int> ticks(times);
+
+    BENCHMARK("Convert 1M times, 5k tempo changes, one by one") {
+        for (int i = 0; i < times; ++i) {
+            ticks[i] = timing.ToTick(ms[i]);
+        }
+        return ticks.back();
+    };
+
+    BENCHMARK("Convert 1M times, 5k tempo changes, sorted batch") {
+        timing.ToTicks(ms, ticks);
+        return ticks.back();
+    };
+}
+
+/**
+ * @test Compares analytic and table-driven easing for Sine, Power and Circular: maximum absolute error over a
+ * dense grid, and the time of 1M calls in each mode.
+ */
+TEST_CASE("Easing Tables", "[benchmark][easing]") {
+    constexpr int samples = 1'000'000;
+
+    std::vector<double> inputs(samples);
+    for (int i = 0; i < samples; ++i) {
+        inputs[i] = static_cast<double>(i) / (samples - 1);
+    }
+
+    for (const Easing easing:
+         {Easing{EasingKind::Sine, 0}, Easing{EasingKind::Power, 3}, Easing{EasingKind::Circular, 0.5}}) {
+        const EasingTable table(easing);
+        const std::string_view kind = GetKindStr(easing.m_kind);
+
+        double solveError = 0;
+        double inverseError = 0;
+        for (const double u: inputs) {
+            for (const EasingMode mode: {EasingMode::In, EasingMode::Out}) {
+                solveError = std::max(solveError, std::abs(table.Solve(u, mode) - easing.Solve(u, mode)));
+                inverseError =
+                        std::max(inverseError, std::abs(table.InverseSolve(u, mode) - easing.InverseSolve(u, mode)));
+            }
+        }
+        std::cout << std::format("{} max abs error: Solve {:.3g}, InverseSolve {:.3g}\n", kind, solveError,
+                                 inverseError);
+
+        BENCHMARK(std::format("{} Solve 1M, analytic", kind)) {
+            double sum = 0;
+            for (const double u: inputs) {
+                sum += easing.Solve(u, EasingMode::Out);
+            }
+            return sum;
+        };
+        BENCHMARK(std::format("{} Solve 1M, table", kind)) {
+            double sum = 0;
+            for (const double u: inputs) {
+                sum += table.Solve(u, EasingMode::Out);
+            }
+            return sum;
+        };
+        BENCHMARK(std::format("{} InverseSolve 1M, analytic", kind)) {
+            double sum = 0;
+            for (const double v: inputs) {
+                sum += easing.InverseSolve(v, EasingMode::Out);
+            }
+            return sum;
+        };
+        BENCHMARK(std::format("{} InverseSolve 1M, table", kind)) {
+            double sum = 0;
+            for (const double v: inputs) {
+                sum += table.InverseSolve(v, EasingMode::Out);
+            }
+            return sum;
+        };
+    }
+}
+
+/**
+ * @test Compares per-value and batch easing over 1M values on the batch kernel this CPU selects.
+ */
+TEST_CASE("Batch Easing", "[benchmark][easing]") {
+    constexpr int samples = 1'000'000;
+
+    std::vector<double> inputs(samples);
+    for (int i = 0; i < samples; ++i) {
+        inputs[i] = static_cast<double>(i) / (samples - 1);
+    }
+    std::vector<double> outputs(samples);
+
+    std::cout << std::format("Batch kernel: {}\n", Easing::GetBatchKernel());
+
+    for (const Easing easing:
+         {Easing{EasingKind::Sine, 0}, Easing{EasingKind::Power, 3}, Easing{EasingKind::Circular, 0.5}}) {
+        const std::string_view kind = GetKindStr(easing.m_kind);
+
+        BENCHMARK(std::format("{} Solve 1M, per value", kind)) {
+            for (int i = 0; i < samples; ++i) {
+                outputs[i] = easing.Solve(inputs[i], EasingMode::In);
+            }
+            return outputs.back();
+        };
+        BENCHMARK(std::format("{} Solve 1M, batch", kind)) {
+            easing.Solve(inputs, outputs, EasingMode::In);
+            return outputs.back();
+        };
+        BENCHMARK(std::format("{} InverseSolve 1M, per value", kind)) {
+            for (int i = 0; i < samples; ++i) {
+                outputs[i] = easing.InverseSolve(inputs[i], EasingMode::In);
+            }
+            return outputs.back();
+        };
+        BENCHMARK(std::format("{} InverseSolve 1M, batch", kind)) {
+            easing.InverseSolve(inputs, outputs, EasingMode::In);
+            return outputs.back();
+        };
+    }
+}
+
+/**
+ * @test Converts 10k chains on one thread keeping the nearest control note at each tick, and choosing them by dynamic
+ * programming over each segment.
+ */
+TEST_CASE("Optimal Sampling", "[benchmark][convert]") {
+    Config cctx;
+    cctx.chains = MakeChains(10'000, 8);
+    cctx.threads = 1;
+    Interpolator greedy(cctx);
+    BENCHMARK("Convert 10k chains, nearest per tick") { return greedy.Convert(); };
+
+    cctx.optimalSampling = true;
+    Interpolator optimal(cctx);
+    BENCHMARK("Convert 10k chains, optimal sampling") { return optimal.Convert(); };
+}
+
+/**
+ * @test Pastes a chain into another of the same size, half of whose joints it repeats, by searching the target for each
+ * pasted joint and sorting, as the control panel used to, and by merging. The search is quadratic, so it stops at 10k.
+ */
+TEST_CASE("Joint Paste", "[benchmark][edit]") {
+    for (const std::size_t count: {std::size_t{10'000}, std::size_t{100'000}}) {
+        mgxc::Chain chain;
+        std::vector<mgxc::Joint> pasted;
+        for (std::size_t i = 0; i < count; ++i) {
+            const int t = static_cast<int>(i) * 10;
+            chain.emplace_back(t, static_cast<int>(i % 16), 0, EasingMode::Linear, EasingMode::Linear);
+            pasted.emplace_back(i % 2 ? t : t + 5, static_cast<int>(i % 16), 0, EasingMode::Linear,
+                                EasingMode::Linear);
+        }
+
+        if (count <= 10'000) {
+            BENCHMARK(std::format("Paste {}k joints, search and sort", count / 1000)) {
+                mgxc::Chain target = chain;
+                for (const mgxc::Joint &joint: pasted) {
+                    if (std::ranges::find(target, joint) == target.end()) {
+                        target.push_back(joint);
+                    }
+                }
+                target.sort();
+                return target.size();
+            };
+        }
+        BENCHMARK(std::format("Paste {}k joints, merge", count / 1000)) {
+            mgxc::Chain target = chain;
+            target.Merge(pasted);
+            return target.size();
+        };
+    }
+}
+
+/**
+ * @test Snaps 1M joints with and without the per-joint atomic ID that Joint used to carry, and converts 10k chains on
+ * one thread, where every joint is snapped once.
+ */
+TEST_CASE("Joint Snapping", "[benchmark][convert]") {
+    constexpr std::size_t count = 1'000'000;
+    std::vector<mgxc::Joint> joints;
+    std::vector<IdJoint> idJoints;
+    for (const mgxc::Chain &chain: MakeChains(count / 8, 8)) {
+        for (const mgxc::Joint &joint: chain) {
+            joints.push_back(joint);
+            idJoints.push_back({joint.t, joint.x, joint.y, joint.eX, joint.eY});
+        }
+    }
+    std::cout << std::format("Joint: {} bytes, with ID: {} bytes\n", sizeof(mgxc::Joint), sizeof(IdJoint));
+
+    std::vector<mgxc::Joint> snapped(joints.size());
+    std::vector<IdJoint> idSnapped(idJoints.size());
+    BENCHMARK("Snap 1M joints, with ID") {
+        for (std::size_t i = 0; i < idJoints.size(); ++i) {
+            idSnapped[i] = idJoints[i].Snap(5);
+        }
+        return idSnapped.back().t;
+    };
+    BENCHMARK("Snap 1M joints") {
+        for (std::size_t i = 0; i < joints.size(); ++i) {
+            snapped[i] = joints[i].Snap(5);
+        }
+        return snapped.back().t;
+    };
+
+    Config cctx;
+    cctx.chains = MakeChains(10'000, 8);
+    cctx.threads = 1;
+    Interpolator interpolator(cctx);
+    BENCHMARK("Convert 10k chains, 1 thread") { return interpolator.Convert(); };
+}
+
+/**
+ * @test Converts 10k chains on 1 to N threads and reports the speedup over a single thread.
+ */
+TEST_CASE("Parallel Convert", "[benchmark][convert]") {
+    Config cctx;
+    cctx.chains = MakeChains(10'000, 8);
+
+    const unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned> threads;
+    for (unsigned n = 1; n < hardware; n *= 2) {
+        threads.push_back(n);
+    }
+    threads.push_back(hardware);
+
+    std::vector<double> timings;
+    for (const unsigned n: threads) {
+        cctx.threads = n;
+        Interpolator interpolator(cctx);
+
+        double best = std::numeric_limits<double>::max();
+        for (int run = 0; run < 5; ++run) {
+            const auto start = std::chrono::steady_clock::now();
+            interpolator.Convert();
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+            best = std::min(best, std::chrono::duration<double, std::milli>(elapsed).count());
+        }
+        timings.push_back(best);
+
+        BENCHMARK(std::format("Convert 10k chains, {} threads", n)) { return interpolator.Convert(); };
+    }
+
+    for (std::size_t i = 0; i < threads.size(); ++i) {
+        std::cout << std::format("Convert 10k chains, {} threads: {:.1f} ms, {:.2f}x\n", threads[i], timings[i],
+                                 timings.front() / timings[i]);
+    }
+}
@@ -0,0 +1,367 @@
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Config.h"
+#include "Log.h"
+#include "Parallel.h"
+#include "aff/Parser.h"
+#include "mgxc/ChainBinary.h"
+#include "mgxc/Interpolator.h"
+#include "mgxc/Primitive.h"
+
+namespace {
+    namespace fs = std::filesystem;
+
+    constexpr std::string_view USAGE = R"(Usage: aircurve-cli [options] <input>...
+
+Converts .aff files, and the .aff files found in input directories, into serialized note chains.
+Chain files given as inputs are converted losslessly to the other chain format: text .mgxc to binary .mgxb and back.
+
+Options:
+  -o <dir>         Write outputs under <dir>, keeping the layout of input directories (default: next to each input)
+  -j <n>           Number of files converted in parallel (default: all hardware threads)
+  --chains         Write the linked chains instead of the converted note chains
+  --binary         Write the linked chains in the binary chain format (.mgxb); implies --chains
+  --snap <n>       Snap tick value (default: 5)
+  --width <n>      Default arc width (default: 4)
+  --til <n>        TIL of the main timeline (default: 0)
+  --easing-tables  Evaluate easing functions through precomputed tables
+  --optimal        Choose control notes that round to the same tick to fit each whole segment best
+  --tolerance <d>  Drop control notes while the curve stays within <d> lanes and height units (default: 0, keep all)
+  --no-clamp       Do not clamp notes to the lanes
+  -v               Log parse and conversion summaries to stderr
+  -h, --help       Show this help
+)";
+
+    /**
+     * @struct Options
+     * @brief Options read from the command line.
+     */
+    struct Options {
+        std::vector<fs::path> inputs; /**< Input files and directories. */
+        fs::path output; /**< Output directory, or empty to write next to each input. */
+        unsigned jobs{0}; /**< Files converted in parallel, or 0 for all hardware threads. */
+        bool chains{false}; /**< If true, write chains instead of note chains. */
+        bool binary{false}; /**< If true, write chains in the binary chain format. */
+        bool verbose{false}; /**< If true, log summaries to stderr. */
+        bool help{false}; /**< If true, show the usage and exit. */
+        Config cctx; /**< Settings shared by every file. */
+    };
+
+    /**
+     * @struct Job
+     * @brief A file to convert.
+     */
+    struct Job {
+        fs::path input; /**< The .aff or chain file. */
+        fs::path output; /**< The file to write. */
+    };
+
+    /**
+     * @struct Result
+     * @brief Sizes and timing of a converted file.
+     */
+    struct Result {
+        std::uintmax_t bytes{0}; /**< Size of the input file. */
+        std::size_t chains{0}; /**< Number of chains parsed. */
+        std::size_t notes{0}; /**< Number of notes produced. */
+        std::size_t skipped{0}; /**< Number of malformed statements skipped. */
+        double ms{0.0}; /**< Time to parse, convert and write the file. */
+    };
+
+    /**
+     * @brief Parses the value of a numeric option.
+     * @param option Name of the option.
+     * @param value Text of the value.
+     * @return The value.
+     * @throws std::invalid_argument if the value is not a non-negative integer.
+     */
+    int ParseCount(const std::string_view option, const std::string_view value) {
+        int result = 0;
+        const auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), result);
+        if (ec != std::errc{} || end != value.data() + value.size() || result < 0) {
+            throw std::invalid_argument(std::format("Invalid value for {}: '{}'", option, value));
+        }
+        return result;
+    }
+
+    /**
+     * @brief Parses the value of a distance option.
+     * @param option Name of the option.
+     * @param value Text of the value.
+     * @return The value.
+     * @throws std::invalid_argument if the value is not a non-negative number.
+     */
+    double ParseDistance(const std::string_view option, const std::string_view value) {
+        double result = 0;
+        const auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), result);
+        if (ec != std::errc{} || end != value.data() + value.size() || !(result >= 0)) {
+            throw std::invalid_argument(std::format("Invalid value for {}: '{}'", option, value));
+        }
+        return result;
+    }
+
+    /**
+     * @brief Reads the options from the command line.
+     * @param args Arguments, without the program name.
+     * @return The options.
+     * @throws std::invalid_argument if an option is unknown or lacks its value.
+     */
+    Options ParseArgs(const std::span<char *const> args) {
+        Options opts;
+        for (std::size_t i = 0; i < args.size(); ++i) {
+            const std::string_view arg = args[i];
+            const auto value = [&]() -> std::string_view {
+                if (i + 1 >= args.size()) {
+                    throw std::invalid_argument(std::format("Missing value for {}", arg));
+                }
+                return args[++i];
+            };
+
+            if (arg == "-h" || arg == "--help") {
+                opts.help = true;
+            } else if (arg == "-o") {
+                opts.output = fs::path(value());
+            } else if (arg == "-j") {
+                opts.jobs = static_cast<unsigned>(ParseCount(arg, value()));
+            } else if (arg == "--chains") {
+                opts.chains = true;
+            } else if (arg == "--binary") {
+                opts.chains = opts.binary = true;
+            } else if (arg == "--snap") {
+                opts.cctx.snap = std::max(1, ParseCount(arg, value()));
+            } else if (arg == "--width") {
+                opts.cctx.width = ParseCount(arg, value());
+            } else if (arg == "--til") {
+                opts.cctx.til = ParseCount(arg, value());
+            } else if (arg == "--easing-tables") {
+                opts.cctx.easingTables = true;
+            } else if (arg == "--optimal") {
+                opts.cctx.optimalSampling = true;
+            } else if (arg == "--tolerance") {
+                opts.cctx.tolerance = ParseDistance(arg, value());
+            } else if (arg == "--no-clamp") {
+                opts.cctx.clamp = false;
+            } else if (arg == "-v") {
+                opts.verbose = true;
+            } else if (arg.starts_with('-')) {
+                throw std::invalid_argument(std::format("Unknown option: {}", arg));
+            } else {
+                opts.inputs.emplace_back(arg);
+            }
+        }
+        return opts;
+    }
+
+    /**
+     * @brief Lists the files to convert, in a stable order.
+     *
+     * Directories are searched recursively for .aff files. With an output directory, each output keeps its path
+     * relative to the input directory it was found in.
+     *
+     * @param opts The options.
+     * @return The jobs, sorted by input path.
+     * @throws std::filesystem::filesystem_error if an input cannot be read.
+     */
+    std::vector<Job> CollectJobs(const Options &opts) {
+        const std::string_view extension = opts.binary ? ".mgxb" : opts.chains ? ".mgxc" : ".notes";
+        const auto add = [&](std::vector<Job> &jobs, const fs::path &file, const fs::path &relative) {
+            fs::path output = opts.output.empty() ? file : opts.output / relative;
+            output.replace_extension(file.extension() == ".mgxc"   ? ".mgxb"
+                                     : file.extension() == ".mgxb" ? ".mgxc"
+                                                                   : extension);
+            jobs.push_back({file, std::move(output)});
+        };
+
+        std::vector<Job> jobs;
+        for (const fs::path &input: opts.inputs) {
+            if (!fs::is_directory(input)) {
+                add(jobs, input, input.filename());
+                continue;
+            }
+
+            for (const fs::directory_entry &entry: fs::recursive_directory_iterator(input)) {
+                if (entry.is_regular_file() && entry.path().extension() == ".aff") {
+                    add(jobs, entry.path(), fs::relative(entry.path(), input));
+                }
+            }
+        }
+
+        std::ranges::sort(jobs, {}, &Job::input);
+        return jobs;
+    }
+
+    /**
+     * @brief Converts a chain file to the other chain format: text to binary, or binary to text.
+     * @param input Path to a .mgxc or .mgxb file.
+     * @param path The same path as UTF-8.
+     * @param result Receives the number of chains.
+     * @return Contents of the converted file.
+     * @throws std::invalid_argument if the file is not a valid chain file.
+     */
+    std::string ConvertChainFile(const fs::path &input, const std::string &path, Result &result) {
+        if (input.extension() == ".mgxb") {
+            const std::vector<mgxc::Chain> chains = mgxc::data::LoadBinary(path);
+            result.chains = chains.size();
+            return mgxc::data::Serialize(chains);
+        }
+
+        std::ifstream in(input, std::ios::binary);
+        const std::string content((std::istreambuf_iterator(in)), (std::istreambuf_iterator<char>()));
+        const std::vector<mgxc::Chain> chains = mgxc::data::Parse(content);
+        result.chains = chains.size();
+        return mgxc::data::SerializeBinary(chains);
+    }
+
+    /**
+     * @brief Parses, converts and writes a single file.
+     * @param job The file to convert.
+     * @param opts The options.
+     * @return Sizes and timing of the conversion.
+     * @throws std::exception if the file cannot be parsed, converted or written.
+     */
+    Result ConvertFile(const Job &job, const Options &opts) {
+        const auto start = std::chrono::steady_clock::now();
+
+        // Files are the unit of parallelism, so each one converts on the thread it was handed to.
+        Config cctx = opts.cctx;
+        cctx.threads = 1;
+
+        const std::u8string u8path = job.input.u8string();
+        const std::string path(u8path.begin(), u8path.end());
+
+        Result result;
+        result.bytes = fs::file_size(job.input);
+
+        std::string text;
+        if (job.input.extension() == ".mgxc" || job.input.extension() == ".mgxb") {
+            text = ConvertChainFile(job.input, path, result);
+        } else {
+            aff::Parser parser(cctx);
+            parser.ParseFile(path);
+            result.chains = cctx.chains.size();
+            result.skipped = parser.GetDiagnostics().size();
+
+            if (opts.binary) {
+                text = mgxc::data::SerializeBinary(cctx.chains);
+            } else if (opts.chains) {
+                text = mgxc::data::Serialize(cctx.chains);
+            } else {
+                Interpolator interpolator(cctx);
+                interpolator.Convert();
+                for (const std::vector<MP_NOTEINFO> &noteChain: interpolator.GetNoteChains()) {
+                    result.notes += noteChain.size();
+                }
+                text = mgxc::data::Serialize(interpolator.GetNoteChains());
+            }
+        }
+
+        if (job.output.has_parent_path()) {
+            fs::create_directories(job.output.parent_path());
+        }
+        std::ofstream out(job.output, std::ios::binary);
+        out.write(text.data(), static_cast<std::streamsize>(text.size()));
+        if (!out) {
+            throw std::runtime_error(std::format("Failed to write {}", job.output.string()));
+        }
+
+        result.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return result;
+    }
+
+    /**
+     * @brief Formats a throughput in MiB/s.
+     * @param bytes Bytes processed.
+     * @param ms Time taken in milliseconds.
+     * @return The formatted throughput.
+     */
+    std::string Throughput(const std::uintmax_t bytes, const double ms) {
+        const double mib = static_cast<double>(bytes) / (1024.0 * 1024.0);
+        return ms > 0.0 ? std::format("{:.1f} MiB/s", mib * 1000.0 / ms) : std::string("-");
+    }
+} // namespace
+
+int main(const int argc, char *argv[]) {
+    Options opts;
+    try {
+        opts = ParseArgs(std::span(argv + 1, argv + argc));
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << "\n\n" << USAGE;
+        return 2;
+    }
+
+    if (opts.help || opts.inputs.empty()) {
+        (opts.help ? std::cout : std::cerr) << USAGE;
+        return opts.help ? 0 : 2;
+    }
+
+    if (opts.verbose) {
+        logging::SetSink(std::make_shared<logging::StreamSink>(std::cerr));
+        logging::SetLevel(logging::Level::Info);
+        if (!logging::IsEnabled<logging::Level::Info>()) {
+            std::cerr << "-v has no effect: summaries are compiled out, see AIRCURVE_LOG_LEVEL\n";
+        }
+    }
+
+    std::vector<Job> jobs;
+    try {
+        jobs = CollectJobs(opts);
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+
+    std::mutex outputMutex;
+    Result total;
+    std::size_t failed = 0;
+
+    utils::parallel_for(
+            jobs.size(),
+            [&](const std::size_t i, unsigned) {
+                const Job &job = jobs[i];
+                try {
+                    const Result result = ConvertFile(job, opts);
+
+                    const std::scoped_lock lock(outputMutex);
+                    std::cout << std::format("{}: {} chains, {} notes, {} skipped, {:.1f} KiB in {:.2f} ms ({})\n",
+                                             job.input.string(), result.chains, result.notes, result.skipped,
+                                             static_cast<double>(result.bytes) / 1024.0, result.ms,
+                                             Throughput(result.bytes, result.ms));
+                    total.bytes += result.bytes;
+                    total.chains += result.chains;
+                    total.notes += result.notes;
+                    total.skipped += result.skipped;
+                } catch (const std::exception &e) {
+                    const std::scoped_lock lock(outputMutex);
+                    std::cerr << std::format("{}: {}\n", job.input.string(), e.what());
+                    ++failed;
+                }
+            },
+            opts.jobs);
+
+    total.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << std::format("{} files, {} failed: {} chains, {} notes, {} skipped in {:.2f} ms on {} jobs ({})\n",
+                             jobs.size(), failed, total.chains, total.notes, total.skipped, total.ms,
+                             std::min<std::size_t>(utils::thread_count(opts.jobs), jobs.size()),
+                             Throughput(total.bytes, total.ms));
+
+    return failed == 0 ? 0 : 1;
+}
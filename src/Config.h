@@ -17,12 +17,26 @@ public:
 
     /** Snap tick value for quantization. */
     MpInteger snap = 5;
+    /** Worker threads for parsing and conversion, or 0 for all hardware threads. */
+    unsigned threads = 0;
+    /** If true, evaluate easing functions through precomputed tables instead of analytically. */
+    bool easingTables{false};
+    /**
+     * If true, choose among the control notes that round to the same tick so that the drawn curve stays closest to the
+     * eased one over each whole segment, instead of keeping the closest note at each tick.
+     */
+    bool optimalSampling{false};
+    /**
+     * Largest distance, in lanes and height units combined, that dropping control notes may move the rendered curve
+     * from the eased one at any tick. 0 keeps every control note.
+     */
+    double tolerance{0};
 
     /** If true, append to existing data when parsing. */
     bool append{false};
     /** Default width for arc parsing. */
     MpInteger width = 4;
-    /** Default TIL value for arc parsing. */
+    /** Default TIL value for arc parsing. Each further timing group takes the next TIL. */
     MpInteger til = 0;
 
     /** Tick offset for commit operations. */
@@ -3,6 +3,7 @@
 #include <atlbase.h>
 #include <atlstr.h>
 #include <cfloat>
+#include <chrono>
 #include <cmath>
 #include <commdlg.h>
 #include <format>
@@ -11,6 +12,7 @@
 #include <string>
 #include <string_view>
 #include <utility>
+#include <vector>
 
 #include "Dialog.h"
 
@@ -134,6 +136,8 @@ void Dialog::UI_Main() {
 
         ImGui::EndTable();
     }
+
+    UI_Panel_Preview();
 }
 
 void Dialog::UI_Panel_Config_Global() {
@@ -144,6 +148,9 @@ void Dialog::UI_Panel_Config_Global() {
     UI_Component_Combo_Division();
     ImGui::PopItemWidth();
 
+    ImGui::Checkbox("Easing Tables", &m_cctx.easingTables);
+    ImGui::Checkbox("Optimal Sampling", &m_cctx.optimalSampling);
+
     ImGui::EndChild();
 }
 
@@ -215,6 +222,7 @@ void Dialog::UI_Panel_Editor_Control() {
 
         const MpInteger previousTick = note.t;
         if (ImGui::InputInt("t", &note.t)) {
+            m_estimateStale = true;
             note.t = (std::max)(note.t, 0);
             if (note.t != previousTick) {
                 SelChain_Sort();
@@ -226,15 +234,22 @@ void Dialog::UI_Panel_Editor_Control() {
         ImGui::Text("-> %d", static_cast<int>(snappedTick));
 
         ImGui::Separator();
-        ImGui::InputInt("x", &note.x);
-        UI_Component_Combo_EasingMode("eX", note.eX);
+        if (ImGui::InputInt("x", &note.x)) {
+            m_estimateStale = true;
+        }
+        if (UI_Component_Combo_EasingMode("eX", note.eX)) {
+            m_estimateStale = true;
+        }
 
         ImGui::Separator();
         if (ImGui::InputInt("y [0,360]", &note.y)) {
+            m_estimateStale = true;
             note.y = std::clamp(note.y, 0, 360);
         }
 
-        UI_Component_Combo_EasingMode("eY", note.eY);
+        if (UI_Component_Combo_EasingMode("eY", note.eY)) {
+            m_estimateStale = true;
+        }
     }
 
     ImGui::PopItemWidth();
@@ -245,6 +260,7 @@ template<std::size_t Min, bool ShowClear, class Container, class Creator, class
 void Dialog::UI_Component_Editor_Vector(int &selIndex, Container &vec, const Creator &creator, const Labeler &labeler,
                                         const Changed &changed, const Extra &extra) {
     if (ImGui::SmallButton("+")) {
+        m_estimateStale = true;
         vec.push_back(std::move(creator()));
         selIndex = static_cast<int>(vec.size()) - 1;
         if constexpr (!std::is_same_v<Changed, std::nullptr_t>) {
@@ -256,6 +272,7 @@ void Dialog::UI_Component_Editor_Vector(int &selIndex, Container &vec, const Cre
     ImGui::SameLine();
     ImGui::BeginDisabled(!canRemove);
     if (ImGui::SmallButton("-") && canRemove) {
+        m_estimateStale = true;
         vec.erase(vec.begin() + selIndex);
 
         if (vec.empty()) {
@@ -276,6 +293,7 @@ void Dialog::UI_Component_Editor_Vector(int &selIndex, Container &vec, const Cre
         ImGui::SameLine();
         ImGui::BeginDisabled(!canClear);
         if (ImGui::SmallButton("Clear") && canClear) {
+            m_estimateStale = true;
             vec.clear();
             selIndex = -1;
         }
@@ -327,14 +345,14 @@ void Dialog::UI_Panel_Selector_Chains() {
         ImGui::PushStyleColor(ImGuiCol_ButtonActive, ImVec4(0.3f, 0.0f, 0.0f, 1.0f));
 
         ImGui::SameLine();
-        ImGui::BeginDisabled(!SelChain_InRange());
+        ImGui::BeginDisabled(!SelChain_InRange() || m_job);
         if (ImGui::SmallButton("Commit")) {
             Commit(m_selChain);
         }
         ImGui::EndDisabled();
 
         ImGui::SameLine();
-        ImGui::BeginDisabled(m_cctx.chains.empty());
+        ImGui::BeginDisabled(m_cctx.chains.empty() || m_job);
         if (ImGui::SmallButton("Commit All") && !m_cctx.chains.empty()) {
             Commit();
         }
@@ -365,6 +383,7 @@ void Dialog::UI_Panel_Selector_Chains() {
                     auto chains = mgxc::data::Parse(text);
                     if (!chains.empty()) {
                         m_cctx.chains.insert(m_cctx.chains.end(), chains.begin(), chains.end());
+                        m_estimateStale = true;
                     }
                 } catch (const std::exception &e) {
                     ShowError(e.what());
@@ -393,10 +412,7 @@ void Dialog::UI_Panel_Selector_Controls() {
             joint.eY = chain[index].eY;
         }
 
-        while (std::ranges::any_of(chain, [&joint](const mgxc::Joint &existing) { return existing.t == joint.t; })) {
-            joint.t += m_cctx.snap;
-        }
-
+        joint.t = chain.FindFreeTick(joint.t, m_cctx.snap);
         return joint;
     };
 
@@ -410,14 +426,17 @@ void Dialog::UI_Panel_Selector_Controls() {
             const char *text = ImGui::GetClipboardText();
             if (text && *text) {
                 try {
+                    std::vector<mgxc::Joint> pasted;
                     for (const mgxc::Chain &chain : mgxc::data::Parse(text)) {
-                        for (const mgxc::Joint &note : chain) {
-                            if (std::ranges::find(selectedChain, note) == selectedChain.end()) {
-                                selectedChain.push_back(note);
-                            }
-                        }
+                        pasted.insert(pasted.end(), chain.begin(), chain.end());
                     }
-                    SelChain_Sort();
+                    if (SelControl_InRange()) {
+                        const auto track = static_cast<std::size_t>(m_selControl);
+                        m_selControl = static_cast<int>(selectedChain.Merge(std::move(pasted), track));
+                    } else {
+                        selectedChain.Merge(std::move(pasted));
+                    }
+                    m_estimateStale = true;
                 } catch (const std::exception &e) {
                     ShowError(e.what());
                 }
@@ -483,7 +502,7 @@ void Dialog::UI_Component_Combo_Note(mgxc::Chain &chain) {
     }
 }
 
-void Dialog::UI_Component_Combo_EasingMode(const std::string_view &label, EasingMode &mode) {
+bool Dialog::UI_Component_Combo_EasingMode(const std::string_view &label, EasingMode &mode) {
     using enum EasingMode;
     static constexpr std::array enumMap{Linear, In, Out};
     static constexpr const char *labels[] = {"Linear", "In", "Out"};
@@ -491,7 +510,9 @@ void Dialog::UI_Component_Combo_EasingMode(const std::string_view &label, Easing
     int curr = utils::enum_to_idx(mode, enumMap);
     if (ImGui::Combo(label.data(), &curr, labels, IM_ARRAYSIZE(labels))) {
         mode = utils::idx_to_enum(curr, enumMap);
+        return true;
     }
+    return false;
 }
 
 void Dialog::UI_Component_Combo_Division() {
@@ -515,6 +536,7 @@ void Dialog::UI_Component_Combo_Division() {
             const std::string label = std::to_string(kSnapDivisors[i]);
             if (ImGui::Selectable(label.c_str(), selected)) {
                 m_cctx.snap = mgxc::BAR_TICKS / kSnapDivisors[i];
+                m_estimateStale = true;
             }
 
             if (selected) {
@@ -527,6 +549,7 @@ void Dialog::UI_Component_Combo_Division() {
     int snapInput = m_cctx.snap;
     if (ImGui::InputInt("Snap Tick", &snapInput)) {
         m_cctx.snap = std::clamp(snapInput, 1, mgxc::BAR_TICKS);
+        m_estimateStale = true;
     }
 }
 
@@ -590,7 +613,114 @@ void Dialog::UI_Panel_Config_Commit() {
 
     ImGui::Checkbox("Clamp (x,y)", &m_cctx.clamp);
 
+    if (ImGui::InputDouble("Tolerance [0,360]", &m_cctx.tolerance, 0.5, 1.0, "%.1f")) {
+        m_cctx.tolerance = std::clamp(m_cctx.tolerance, 0.0, 360.0);
+    }
+
     ImGui::PopItemWidth();
+
+    if (m_job) {
+        const std::string progress = std::format("{}/{} chains", m_job->GetDone(), m_job->GetTotal());
+        ImGui::ProgressBar(m_job->GetProgress(), {-FLT_MIN, 0}, progress.c_str());
+        if (ImGui::SmallButton("Cancel")) {
+            m_job->Cancel();
+        }
+    } else {
+        const ConversionCache::Stats stats = m_cache.GetStats();
+        ImGui::TextDisabled("Cache: %zu hits, %zu misses, %zu chains", stats.hits, stats.misses, stats.entries);
+        if (m_cctx.tolerance > 0) {
+            ImGui::TextDisabled("Last commit: %zu control notes dropped from the chains converted, not cache hits",
+                                m_session.GetInterpolator().GetDropped());
+        }
+
+        // Bounded from the joints alone, and only recomputed after they or the snap change rather than every frame.
+        // The time assumes the speed of the last conversion and no cache hits.
+        if (m_estimateStale) {
+            m_estimate = Interpolator::EstimateOutput(m_cctx);
+            m_estimateStale = false;
+        }
+        const Interpolator::Estimate &estimate = m_estimate;
+        const double throughput = m_session.GetInterpolator().GetThroughput();
+        if (throughput > 0) {
+            ImGui::TextDisabled("Commit All: up to %zu notes, ~%.0f ms", estimate.notes,
+                                static_cast<double>(estimate.notes) / throughput * 1000.0);
+        } else {
+            ImGui::TextDisabled("Commit All: up to %zu notes", estimate.notes);
+        }
+        if (estimate.largest > Interpolator::MAX_CHAIN_NOTES) {
+            ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "A chain exceeds %zu notes and will be rejected",
+                               Interpolator::MAX_CHAIN_NOTES);
+        }
+    }
+
+    ImGui::EndChild();
+}
+
+void Dialog::UI_Panel_Preview() {
+    ImGui::Text("Preview [%d]", m_selChain);
+    ImGui::BeginChild("##Preview", {0, m_previewHeight}, ImGuiChildFlags_Border);
+
+    if (!SelChain_InRange() || m_cctx.chains[m_selChain].size() < 2) {
+        m_preview.Reset();
+        m_previewChain = -1;
+        ImGui::EndChild();
+        return;
+    }
+    if (m_previewChain != m_selChain) {
+        m_preview.Reset();
+        m_previewChain = m_selChain;
+    }
+
+    // A slice of the frame: long chains catch up over a few frames instead of stalling one.
+    constexpr auto budget = std::chrono::milliseconds(2);
+    const mgxc::Chain &chain = m_cctx.chains[m_selChain];
+    m_preview.Update(chain, budget);
+
+    const ImVec2 origin = ImGui::GetCursorScreenPos();
+    const ImVec2 area = ImGui::GetContentRegionAvail();
+    const float half = area.y * 0.5f;
+    const double t0 = chain.front().t;
+    const double span = (std::max)(1.0, static_cast<double>(chain.back().t) - t0);
+
+    ImDrawList *draw = ImGui::GetWindowDrawList();
+    draw->AddLine({origin.x, origin.y + half}, {origin.x + area.x, origin.y + half}, IM_COL32(128, 128, 128, 96));
+
+    // One polyline per plot; points closer than a pixel to the last one kept are dropped.
+    std::vector<ImVec2> points;
+    const auto plot = [&](const double max, const float top, const ImU32 color, auto value) {
+        points.clear();
+        for (std::size_t i = 0; i < m_preview.GetSegmentCount(); ++i) {
+            for (const mgxc::ChainPreview::Point &p: m_preview.GetSegment(i)) {
+                const ImVec2 point{origin.x + static_cast<float>((p.t - t0) / span) * area.x,
+                                   top + half - static_cast<float>(std::clamp(value(p) / max, 0.0, 1.0)) * half};
+                if (points.empty() || std::abs(point.x - points.back().x) >= 1.0f ||
+                    std::abs(point.y - points.back().y) >= 1.0f) {
+                    points.push_back(point);
+                }
+            }
+        }
+        draw->AddPolyline(points.data(), static_cast<int>(points.size()), color, ImDrawFlags_None, 1.5f);
+    };
+    plot(16.0, origin.y, IM_COL32(80, 200, 255, 255), [](const mgxc::ChainPreview::Point &p) { return p.x; });
+    plot(360.0, origin.y + half, IM_COL32(255, 170, 60, 255), [](const mgxc::ChainPreview::Point &p) { return p.y; });
+
+    if (SelControl_InRange()) {
+        const mgxc::Joint &joint = chain[m_selControl];
+        const float x = origin.x + static_cast<float>((joint.t - t0) / span) * area.x;
+        draw->AddCircleFilled({x, origin.y + half - static_cast<float>(std::clamp(joint.x / 16.0, 0.0, 1.0)) * half},
+                              3.0f, IM_COL32_WHITE);
+        draw->AddCircleFilled({x, origin.y + area.y - static_cast<float>(std::clamp(joint.y / 360.0, 0.0, 1.0)) * half},
+                              3.0f, IM_COL32_WHITE);
+    }
+
+    ImGui::TextDisabled("x");
+    ImGui::SetCursorScreenPos({origin.x, origin.y + half});
+    ImGui::TextDisabled("height");
+    if (m_preview.GetDirtyCount() > 0) {
+        ImGui::SameLine();
+        ImGui::TextDisabled("(updating %zu segments)", m_preview.GetDirtyCount());
+    }
+
     ImGui::EndChild();
 }
 
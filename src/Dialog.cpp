@@ -4,6 +4,7 @@
 #include <atltypes.h>
 #include <cstring>
 #include <filesystem>
+#include <format>
 #include <imgui.h>
 #include <imgui_impl_dx11.h>
 #include <imgui_impl_win32.h>
@@ -15,6 +16,7 @@
 
 #include "aff/Parser.h"
 #include "meta.h"
+#include "mgxc/MargreteChartWriter.h"
 
 namespace {
 std::string ToUtf8Path(const wchar_t *path) {
@@ -169,7 +171,8 @@ HRESULT Dialog::ShowDialog() {
         return E_FAIL;
     }
 
-    RECT rect = {0, 0, 740, 370};
+    // Tall enough for the config column, the tallest of the three, and the preview below them.
+    RECT rect = {0, 0, 740, 660};
     const HWND dialog = Create(owner, rect, W_DIALOG_TITLE, WS_POPUP | WS_VISIBLE | WS_CLIPCHILDREN | WS_CLIPSIBLINGS);
     if (dialog == nullptr) {
         const DWORD lastError = GetLastError();
@@ -212,6 +215,7 @@ void Dialog::RenderImGui() {
             break;
         }
 
+        PollJob();
         UI_Error();
 
         ImGui::SetNextWindowPos(ImVec2(0, 0));
@@ -234,6 +238,8 @@ void Dialog::RenderImGui() {
             m_running = false;
         }
     }
+
+    m_job.reset();
 }
 
 #pragma endregion Dialog
@@ -257,20 +263,53 @@ void Dialog::ShowError(std::string text) {
 }
 
 bool Dialog::TryImportAffFile(const std::string &filePath) {
+    // Set up front: a failed import may still have appended some chains.
+    m_estimateStale = true;
     return Catch([this, &filePath] {
         aff::Parser parser(m_cctx);
         parser.ParseFile(filePath);
+
+        const std::vector<aff::Diagnostic> &diagnostics = parser.GetDiagnostics();
+        if (diagnostics.empty()) {
+            return;
+        }
+
+        constexpr std::size_t maxShown = 10;
+        std::string text = std::format("Skipped {} malformed statement(s):", diagnostics.size());
+        for (std::size_t i = 0; i < diagnostics.size() && i < maxShown; ++i) {
+            const aff::Diagnostic &d = diagnostics[i];
+            text += std::format("\n{}:{}: {}", d.loc.line, d.loc.column, d.message);
+        }
+        if (diagnostics.size() > maxShown) {
+            text += "\n...";
+        }
+        ShowError(std::move(text));
     });
 }
 
 void Dialog::Commit(const int idx) {
+    if (m_job) {
+        return;
+    }
+
     Catch([this, idx] {
         m_cctx.tOffset = m_mg.GetTickOffset();
-        Interpolator interpolator(m_cctx);
-        interpolator.Convert(idx);
+        m_job = std::make_unique<ConversionJob>(m_session, m_cctx, idx, m_st);
+    });
+}
+
+void Dialog::PollJob() {
+    if (!m_job || !m_job->IsFinished()) {
+        return;
+    }
 
+    // Conversion ran on the job's thread; only the undo-recorded commit touches the chart, here on the UI thread.
+    const std::unique_ptr<ConversionJob> job = std::move(m_job);
+    Catch([this, &job] {
+        job->Rethrow();
         if (m_mg.CanCommit()) {
-            interpolator.Commit(m_mg);
+            MargreteChartWriter writer(m_mg);
+            job->Commit(writer);
         }
     });
 }
@@ -282,16 +321,7 @@ void Dialog::SelChain_Sort() {
         return;
     }
 
-    mgxc::Chain &chain = m_cctx.chains[m_selChain];
-    const size_t selectedId = chain[m_selControl].GetID();
-    chain.sort();
-
-    for (std::size_t i = 0; i < chain.size(); ++i) {
-        if (chain[i].GetID() == selectedId) {
-            m_selControl = static_cast<int>(i);
-            break;
-        }
-    }
+    m_selControl = static_cast<int>(m_cctx.chains[m_selChain].sort(static_cast<std::size_t>(m_selControl)));
 }
 
 bool Dialog::SelChain_InRange() const noexcept { return utils::in_bounds(m_cctx.chains, m_selChain); }
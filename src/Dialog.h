@@ -6,8 +6,13 @@
 #include <atlctrls.h>
 #include <atlwin.h>
 #include <d3d11.h>
+#include <memory>
 
+#include "mgxc/ChainPreview.h"
+#include "mgxc/ConversionJob.h"
+#include "mgxc/ConversionSession.h"
 #include "mgxc/Interpolator.h"
+#include "mgxc/MargreteHandle.h"
 
 #pragma comment(linker, "\"/manifestdependency:type='win32' \
 name='Microsoft.Windows.Common-Controls' version='6.0.0.0' \
@@ -70,11 +75,27 @@ private:
     bool m_running{false};
     /** Stop token for cooperative cancellation. */
     std::stop_token m_st;
+    /** Chains converted by earlier commits, reused while they are unchanged. */
+    ConversionCache m_cache;
+    /** Snapshot and interpolator reused by every commit, so repeated commits reuse their storage. */
+    ConversionSession m_session{&m_cache};
+    /** Conversion running in the background, committed once it finishes. Declared after m_session, which it uses. */
+    std::unique_ptr<ConversionJob> m_job;
+    /** Sampled curve of the selected chain. */
+    mgxc::ChainPreview m_preview;
+    /** Chain the preview was last updated for. */
+    int m_previewChain{-1};
+    /** Bound on the output of Commit All, shown in the commit panel. */
+    Interpolator::Estimate m_estimate{};
+    /** If true, joints or the snap changed since m_estimate was computed. */
+    bool m_estimateStale{true};
 
     /** Width of the child window. */
     float m_childWidth{235.0f};
     /** Height of the child window. */
     float m_childHeight{150.0f};
+    /** Height of the preview below the columns. */
+    float m_previewHeight{150.0f};
 
     /** Selected chain index. */
     int m_selChain{-1};
@@ -109,6 +130,7 @@ private:
     void ShowError(std::string text);
     bool TryImportAffFile(const std::string &filePath);
     void Commit(int idx = -1);
+    void PollJob();
     void SelChain_Sort();
     bool SelChain_InRange() const noexcept;
     bool SelControl_InRange() const noexcept;
@@ -129,9 +151,11 @@ private:
     void UI_Panel_Selector_Controls();
     void UI_Panel_Editor_Control();
 
+    void UI_Panel_Preview();
+
     void UI_Component_Combo_Division();
     static void UI_Component_Combo_EasingKind(mgxc::Chain &chain);
-    static void UI_Component_Combo_EasingMode(const std::string_view &label, EasingMode &mode);
+    static bool UI_Component_Combo_EasingMode(const std::string_view &label, EasingMode &mode);
     static void UI_Component_Combo_Note(mgxc::Chain &chain);
 
     void UI_Component_Button_File();
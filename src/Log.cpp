@@ -0,0 +1,36 @@
+#include <atomic>
+#include <mutex>
+
+#include "Log.h"
+
+namespace logging {
+    namespace {
+        std::mutex g_mutex;
+        std::shared_ptr<Sink> g_sink;
+        std::atomic_bool g_hasSink{false};
+        std::atomic<Level> g_level{Level::Info};
+    } // namespace
+
+    void StreamSink::Write(const Level level, const std::string_view message) {
+        m_stream << '[' << GetLevelStr(level) << "] " << message << '\n';
+    }
+
+    void SetSink(std::shared_ptr<Sink> sink) {
+        const std::scoped_lock lock(g_mutex);
+        g_hasSink = sink != nullptr;
+        g_sink = std::move(sink);
+    }
+
+    void SetLevel(const Level level) noexcept { g_level = level; }
+
+    bool IsEnabled(const Level level) noexcept {
+        return level >= COMPILED_LEVEL && level >= g_level && level != Level::Off && g_hasSink;
+    }
+
+    void Write(const Level level, const std::string_view message) {
+        const std::scoped_lock lock(g_mutex);
+        if (g_sink) {
+            g_sink->Write(level, message);
+        }
+    }
+} // namespace logging
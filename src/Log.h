@@ -0,0 +1,150 @@
+#pragma once
+
+#include <format>
+#include <memory>
+#include <ostream>
+#include <string_view>
+#include <utility>
+
+/**
+ * Lowest log level compiled in: 0 Trace, 1 Debug, 2 Info, 3 Warn, 4 Error, 5 Off.
+ * Calls below it compile to nothing, so by default logging costs nothing at all.
+ */
+#ifndef AIRCURVE_LOG_LEVEL
+#define AIRCURVE_LOG_LEVEL 5
+#endif
+
+namespace logging {
+    /**
+     * @enum Level
+     * @brief Severity of a log message.
+     *
+     * Info carries summaries (counts, timings, chain sizes); Trace carries per-joint and per-note dumps.
+     */
+    enum class Level : int {
+        Trace = 0,
+        Debug = 1,
+        Info = 2,
+        Warn = 3,
+        Error = 4,
+        Off = 5,
+    };
+
+    /** Lowest level compiled in, from AIRCURVE_LOG_LEVEL. */
+    constexpr Level COMPILED_LEVEL = static_cast<Level>(AIRCURVE_LOG_LEVEL);
+
+    /**
+     * @brief Returns the name of a Level.
+     * @param level The Level value.
+     * @return String view of the level name.
+     */
+    constexpr std::string_view GetLevelStr(const Level level) {
+        switch (level) {
+            using enum Level;
+            case Trace:
+                return "trace";
+            case Debug:
+                return "debug";
+            case Info:
+                return "info";
+            case Warn:
+                return "warn";
+            case Error:
+                return "error";
+            default:
+                return "??";
+        }
+    }
+
+    /**
+     * @class Sink
+     * @brief Receives formatted log messages.
+     *
+     * Writes are serialized by the logger, so a sink does not need its own locking.
+     */
+    class Sink {
+    public:
+        virtual ~Sink() = default;
+
+        /**
+         * @brief Writes a message.
+         * @param level Severity of the message.
+         * @param message The message, without a trailing newline.
+         */
+        virtual void Write(Level level, std::string_view message) = 0;
+    };
+
+    /**
+     * @class StreamSink
+     * @brief Writes messages to a stream, one line each, without flushing per line.
+     */
+    class StreamSink final : public Sink {
+    public:
+        /**
+         * @brief Constructs a StreamSink.
+         * @param stream Stream to write to. Must outlive the sink.
+         */
+        explicit StreamSink(std::ostream &stream) : m_stream(stream) {}
+
+        void Write(Level level, std::string_view message) override;
+
+    private:
+        std::ostream &m_stream; /**< Stream to write to. */
+    };
+
+    /**
+     * @brief Installs the sink that receives messages, replacing the current one.
+     * @param sink The sink, or nullptr to drop all messages.
+     */
+    void SetSink(std::shared_ptr<Sink> sink);
+    /**
+     * @brief Sets the lowest level passed on to the sink at runtime.
+     * @param level The level. Levels below COMPILED_LEVEL stay disabled.
+     */
+    void SetLevel(Level level) noexcept;
+    /**
+     * @brief Checks at runtime if a level reaches the sink.
+     * @param level The level to check.
+     * @return True if a sink is installed and the level is enabled.
+     */
+    bool IsEnabled(Level level) noexcept;
+    /**
+     * @brief Passes a formatted message to the sink.
+     * @param level Severity of the message.
+     * @param message The message.
+     */
+    void Write(Level level, std::string_view message);
+
+    /**
+     * @brief Checks if a level is compiled in and reaches the sink.
+     *
+     * Use it to skip gathering the data of a message, not just formatting it.
+     *
+     * @tparam L The level to check.
+     * @return True if messages at L are written.
+     */
+    template<Level L>
+    bool IsEnabled() noexcept {
+        if constexpr (L < COMPILED_LEVEL || L == Level::Off) {
+            return false;
+        } else {
+            return IsEnabled(L);
+        }
+    }
+
+    /**
+     * @brief Formats and writes a message if its level is enabled.
+     * @tparam L Severity of the message.
+     * @tparam Args Format argument types.
+     * @param fmt Format string.
+     * @param args Format arguments.
+     */
+    template<Level L, class... Args>
+    void Log(const std::format_string<Args...> fmt, Args &&...args) {
+        if constexpr (L >= COMPILED_LEVEL && L != Level::Off) {
+            if (IsEnabled(L)) {
+                Write(L, std::format(fmt, std::forward<Args>(args)...));
+            }
+        }
+    }
+} // namespace logging
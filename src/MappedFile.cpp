@@ -0,0 +1,152 @@
+#include <cstdint>
+#include <filesystem>
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif __has_include(<sys/mman.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MAPPEDFILE_POSIX
+#endif
+
+#include "MappedFile.h"
+
+namespace utils {
+    MappedFile::~MappedFile() { Close(); }
+
+    MappedFile::MappedFile(MappedFile &&other) noexcept :
+        m_data(std::exchange(other.m_data, nullptr)), m_size(std::exchange(other.m_size, 0)),
+        m_open(std::exchange(other.m_open, false)) {}
+
+    MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+        if (this != &other) {
+            Close();
+            m_data = std::exchange(other.m_data, nullptr);
+            m_size = std::exchange(other.m_size, 0);
+            m_open = std::exchange(other.m_open, false);
+        }
+        return *this;
+    }
+
+#if defined(_WIN32)
+
+    bool MappedFile::Open(const std::string &filePath) noexcept {
+        Close();
+
+        std::wstring widePath;
+        try {
+            widePath = std::filesystem::path(std::u8string(filePath.begin(), filePath.end())).wstring();
+        } catch (...) {
+            return false;
+        }
+
+        const HANDLE file = CreateFileW(widePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+
+        LARGE_INTEGER size{};
+        if (!GetFileSizeEx(file, &size) || static_cast<unsigned long long>(size.QuadPart) > SIZE_MAX) {
+            CloseHandle(file);
+            return false;
+        }
+
+        if (size.QuadPart == 0) {
+            CloseHandle(file);
+            m_open = true;
+            return true;
+        }
+
+        const HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (mapping == nullptr) {
+            return false;
+        }
+
+        // The view keeps the mapping object alive on its own.
+        const void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+        if (view == nullptr) {
+            return false;
+        }
+
+        m_data = static_cast<const char *>(view);
+        m_size = static_cast<std::size_t>(size.QuadPart);
+        m_open = true;
+        return true;
+    }
+
+    void MappedFile::Close() noexcept {
+        if (m_data) {
+            UnmapViewOfFile(m_data);
+        }
+        m_data = nullptr;
+        m_size = 0;
+        m_open = false;
+    }
+
+#elif defined(MAPPEDFILE_POSIX)
+
+    bool MappedFile::Open(const std::string &filePath) noexcept {
+        Close();
+
+        const int fd = ::open(filePath.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+
+        struct stat st{};
+        if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+            ::close(fd);
+            return false;
+        }
+
+        if (st.st_size == 0) {
+            ::close(fd);
+            m_open = true;
+            return true;
+        }
+
+        void *view = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        // The mapping keeps the file referenced on its own.
+        ::close(fd);
+        if (view == MAP_FAILED) {
+            return false;
+        }
+
+        ::madvise(view, static_cast<std::size_t>(st.st_size), MADV_SEQUENTIAL);
+
+        m_data = static_cast<const char *>(view);
+        m_size = static_cast<std::size_t>(st.st_size);
+        m_open = true;
+        return true;
+    }
+
+    void MappedFile::Close() noexcept {
+        if (m_data) {
+            ::munmap(const_cast<char *>(m_data), m_size);
+        }
+        m_data = nullptr;
+        m_size = 0;
+        m_open = false;
+    }
+
+#else
+
+    bool MappedFile::Open(const std::string &) noexcept { return false; }
+
+    void MappedFile::Close() noexcept {
+        m_data = nullptr;
+        m_size = 0;
+        m_open = false;
+    }
+
+#endif
+} // namespace utils
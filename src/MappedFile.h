@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace utils {
+    /**
+     * @class MappedFile
+     * @brief Read-only memory mapping of a whole file.
+     *
+     * Uses mmap on POSIX and file mappings on Windows. Open fails on other platforms, so callers keep a
+     * stream-based fallback.
+     */
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+        MappedFile(MappedFile &&other) noexcept;
+        MappedFile &operator=(MappedFile &&other) noexcept;
+
+        /**
+         * @brief Maps a file, replacing any current mapping.
+         * @param filePath UTF-8 path to the file.
+         * @return True if the file is mapped.
+         */
+        bool Open(const std::string &filePath) noexcept;
+        /**
+         * @brief Unmaps the current file, if any.
+         */
+        void Close() noexcept;
+
+        /**
+         * @brief Checks if a file is mapped.
+         * @return True if a file is mapped.
+         */
+        bool IsOpen() const noexcept { return m_open; }
+        /**
+         * @brief Gets the mapped contents.
+         * @return View of the file, valid until the mapping is closed.
+         */
+        std::string_view View() const noexcept { return {m_data, m_size}; }
+
+    private:
+        const char *m_data{nullptr}; /**< Start of the mapping. */
+        std::size_t m_size{0}; /**< Size of the mapping in bytes. */
+        bool m_open{false}; /**< Indicates if a file is mapped. */
+    };
+} // namespace utils
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace utils {
+    /**
+     * @brief Resolves a requested thread count.
+     * @param threads Requested number of threads, or 0 for all hardware threads.
+     * @return The number of threads to use, at least 1.
+     */
+    inline unsigned thread_count(const unsigned threads) noexcept {
+        if (threads != 0) {
+            return threads;
+        }
+        return (std::max)(1u, std::thread::hardware_concurrency());
+    }
+
+    /**
+     * @brief Runs fn(index, worker) for every index in [0, count) on a pool of worker threads.
+     *
+     * Indices are handed out one at a time from a shared counter, so uneven work balances across workers.
+     * The calling thread acts as worker 0. If fn throws, the remaining indices are skipped and the first
+     * exception is rethrown on the calling thread once every worker has stopped.
+     *
+     * @tparam F Callable as fn(std::size_t index, unsigned worker).
+     * @param count Number of indices.
+     * @param fn The function to run.
+     * @param threads Maximum number of workers, or 0 for all hardware threads.
+     */
+    template<class F>
+    void parallel_for(const std::size_t count, F &&fn, const unsigned threads = 0) {
+        const unsigned workers = static_cast<unsigned>((std::min<std::size_t>)(thread_count(threads), count));
+        if (workers <= 1) {
+            for (std::size_t i = 0; i < count; ++i) {
+                fn(i, 0u);
+            }
+            return;
+        }
+
+        std::atomic_size_t next{0};
+        std::atomic_bool failed{false};
+        std::exception_ptr error;
+        std::mutex errorMutex;
+
+        const auto run = [&](const unsigned worker) {
+            try {
+                for (std::size_t i = next++; i < count && !failed; i = next++) {
+                    fn(i, worker);
+                }
+            } catch (...) {
+                const std::scoped_lock lock(errorMutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+                failed = true;
+            }
+        };
+
+        {
+            std::vector<std::jthread> pool;
+            pool.reserve(workers - 1);
+            for (unsigned worker = 1; worker < workers; ++worker) {
+                pool.emplace_back(run, worker);
+            }
+            run(0);
+        }
+
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+} // namespace utils
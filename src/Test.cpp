@@ -1,25 +1,1048 @@
 ﻿#define CATCH_CONFIG_MAIN
 #include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_string.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <filesystem>
+#include <format>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
 
+#include "AllocationCounter.h"
 #include "Dialog.h"
+#include "Log.h"
+#include "aff/Linker.h"
 #include "aff/Parser.h"
+#include "aff/Timing.h"
+#include "aff/Tokenizer.h"
+#include "mgxc/ChainBinary.h"
+#include "mgxc/ChainPreview.h"
+#include "mgxc/ChartWriter.h"
+#include "mgxc/ComChartWriter.h"
+#include "mgxc/ConversionCache.h"
+#include "mgxc/ConversionJob.h"
+#include "mgxc/ConversionSession.h"
+#include "mgxc/EasingTable.h"
 #include "mgxc/Interpolator.h"
+#include "mgxc/MockMargrete.h"
 
 static Config g_cctx;
 static IMargretePluginContext *g_ctx = nullptr;
 
+/**
+ * @brief Measures how far the curve the chart draws through converted notes is from a chain's eased curve at a tick.
+ * @param chain The chain, with its joints on the snap.
+ * @param notes The note chain it converted to, without offsets.
+ * @param tick Tick between the chain's first and last joints.
+ * @return Distance in lanes and height units combined.
+ */
+static double CurveDistance(const mgxc::Chain &chain, const std::vector<MP_NOTEINFO> &notes, const int tick) {
+    const auto joint = std::clamp(std::ranges::upper_bound(chain, tick, {}, &mgxc::Joint::t), chain.begin() + 1,
+                                  chain.end() - 1);
+    const mgxc::Joint &curr = *(joint - 1);
+    const mgxc::Joint &next = *joint;
+    const double u = static_cast<double>(tick - curr.t) / (next.t - curr.t);
+    const double x = curr.x + chain.es.Solve(u, curr.eX) * (next.x - curr.x);
+    const double y = curr.y + chain.es.Solve(u, curr.eY) * (next.y - curr.y);
+
+    const auto note = std::clamp(std::ranges::upper_bound(notes, tick, {}, &MP_NOTEINFO::tick), notes.begin() + 1,
+                                 notes.end() - 1);
+    const MP_NOTEINFO &prev = *(note - 1);
+    const double f = static_cast<double>(tick - prev.tick) / (note->tick - prev.tick);
+    return std::hypot(prev.x + f * (note->x - prev.x) - x, prev.height + f * (note->height - prev.height) - y);
+}
+
 /**
  * @test Parses an .aff file and runs interpolation on the parsed data.
  */
 TEST_CASE("Parse & Interpolate") {
     auto parser = aff::Parser(g_cctx);
-    parser.ParseFile("../../../aff/2.aff");
+    parser.ParseFile(AIRCURVE_AFF_DIR "/2.aff");
 
     auto intp = Interpolator(g_cctx);
     intp.Convert();
 }
 
+/**
+ * @test Links arcs into chains and stops a chain where more than one arc continues it.
+ */
+TEST_CASE("Link Arcs") {
+    const auto arc = [](const int t, const int toT, const int x, const int toX) {
+        aff::Arc a;
+        a.t = t;
+        a.toT = toT;
+        a.x = x;
+        a.toX = toX;
+        return a;
+    };
+
+    const std::vector arcs{arc(0, 10, 0, 1), arc(10, 20, 1, 2), arc(20, 30, 2, 3), arc(20, 30, 2, 4)};
+    const std::vector<std::vector<aff::Arc>> chains = aff::Linker(arcs).Link();
+
+    REQUIRE(chains.size() == 3);
+    REQUIRE(chains[0].size() == 2);
+    REQUIRE(chains[0].back().toT == 20);
+    REQUIRE(chains[1].size() == 1);
+    REQUIRE(chains[1].front().toX == 3);
+    REQUIRE(chains[2].size() == 1);
+    REQUIRE(chains[2].front().toX == 4);
+}
+
+/**
+ * @test Tokenizes arcs and parses their numbers without touching the heap.
+ */
+TEST_CASE("Tokenize Without Allocation") {
+    std::string text = "AudioOffset:0\n-\ntiming(0,100.00,4.00);\n";
+    for (int i = 0; i < 1000; ++i) {
+        text += std::format("arc({},{},0.00,1.00,s,0.00,1.00,0,none,false)[arctap({})];\n", i * 100, i * 100 + 100,
+                            i * 100);
+    }
+
+    std::size_t arcs = 0;
+    bool valid = true;
+
+    const std::size_t before = utils::CountThreadAllocations();
+    {
+        aff::Tokenizer tokenizer(text);
+        aff::Event event;
+        while (tokenizer.Next(event)) {
+            if (event.kind != aff::Event::Kind::Call || event.name != "arc") {
+                continue;
+            }
+
+            int t;
+            double x;
+            valid = valid && event.argc == 10 && aff::ToInt(event.args[0], t) && aff::ToDouble(event.args[2], x);
+            ++arcs;
+        }
+    }
+    const std::size_t allocations = utils::CountThreadAllocations() - before;
+
+    REQUIRE(allocations == 0);
+    REQUIRE(valid);
+    REQUIRE(arcs == 1000);
+}
+
+/**
+ * @test Reports the line and column of malformed statements instead of dropping them silently.
+ */
+TEST_CASE("Report Malformed Statements") {
+    Config cctx;
+    aff::Parser parser(cctx);
+    parser.Parse("timing(0,100.00,4.00);\n"
+                 "arc(0,150,0.00,1.00,s,0.00,1.00,0,none,false);\n"
+                 "  arc(150,300,0.00,oops,s,0.00,1.00,0,none,false);\n"
+                 "arc(300,450\n");
+
+    const std::vector<aff::Diagnostic> &diagnostics = parser.GetDiagnostics();
+    REQUIRE(diagnostics.size() == 2);
+    REQUIRE(diagnostics[0].loc.line == 3);
+    REQUIRE(diagnostics[0].loc.column == 3);
+    REQUIRE(diagnostics[1].loc.line == 5);
+    REQUIRE(cctx.chains.size() == 1);
+}
+
+/**
+ * @test Converts milliseconds to ticks across tempo changes, one at a time and in a sorted batch.
+ */
+TEST_CASE("Convert Across Tempo Changes") {
+    aff::TimingMap timing(mgxc::BEAT_TICKS);
+    timing.Add(1000, 240.0);
+    timing.Add(0, 120.0);
+    timing.Build();
+
+    REQUIRE(timing.ToTick(500) == 480);
+    REQUIRE(timing.ToTick(1000) == 960);
+    REQUIRE(timing.ToTick(1250) == 1440);
+
+    const std::vector ms{0, 500, 1000, 1250};
+    std::vector<int> ticks(ms.size());
+    timing.ToTicks(ms, ticks);
+    REQUIRE(ticks == std::vector{0, 480, 960, 1440});
+
+    Config cctx;
+    aff::Parser parser(cctx);
+    parser.Parse("timing(0,120.00,4.00);\n"
+                 "timing(1000,240.00,4.00);\n"
+                 "arc(500,1250,0.00,1.00,s,0.00,1.00,0,none,false);\n");
+
+    REQUIRE(cctx.chains.size() == 1);
+    REQUIRE(cctx.chains[0].front().t == 480);
+    REQUIRE(cctx.chains[0].back().t == 1440);
+}
+
+/**
+ * @test Parses two timing groups with their own tempo and checks that each lands on its own TIL.
+ */
+TEST_CASE("Parse Timing Groups") {
+    Config cctx;
+    cctx.til = 2;
+    aff::Parser parser(cctx);
+    parser.Parse("timing(0,120.00,4.00);\n"
+                 "arc(0,500,0.00,1.00,s,0.00,1.00,0,none,false);\n"
+                 "timinggroup(){\n"
+                 "  timing(0,240.00,4.00);\n"
+                 "  arc(0,500,0.00,1.00,s,0.00,1.00,0,none,false);\n"
+                 "};\n"
+                 "timinggroup(noinput){\n"
+                 "  arc(0,500,1.00,0.00,s,1.00,0.00,0,none,true);\n"
+                 "};\n");
+
+    REQUIRE(parser.GetDiagnostics().empty());
+    REQUIRE(cctx.chains.size() == 3);
+    REQUIRE(cctx.chains[0].til == 2);
+    REQUIRE(cctx.chains[0].back().t == 480);
+    REQUIRE(cctx.chains[1].til == 3);
+    REQUIRE(cctx.chains[1].back().t == 960);
+    // A group without timing follows the main tempo.
+    REQUIRE(cctx.chains[2].til == 4);
+    REQUIRE(cctx.chains[2].back().t == 480);
+}
+
+/**
+ * @test Checks that easing tables stay within their error bound and keep the curves monotone.
+ */
+TEST_CASE("Tabulate Easing") {
+    for (const Easing easing: {Easing{EasingKind::Sine, 0}, Easing{EasingKind::Power, 0.5},
+                               Easing{EasingKind::Power, 4}, Easing{EasingKind::Circular, 0}}) {
+        const EasingTable table(easing);
+        REQUIRE(table.IsForwardTabulated());
+        REQUIRE(table.IsInverseTabulated());
+
+        for (const EasingMode mode: {EasingMode::In, EasingMode::Out}) {
+            double prevSolve = 0;
+            double prevInverse = 0;
+            for (int i = 0; i <= 100'000; ++i) {
+                const double u = i / 100'000.0;
+                const double solved = table.Solve(u, mode);
+                const double inverse = table.InverseSolve(u, mode);
+
+                REQUIRE(std::abs(solved - easing.Solve(u, mode)) <= EasingTable::DEFAULT_TOLERANCE);
+                REQUIRE(std::abs(inverse - easing.InverseSolve(u, mode)) <= EasingTable::DEFAULT_TOLERANCE);
+                REQUIRE(solved >= prevSolve);
+                REQUIRE(inverse >= prevInverse);
+
+                prevSolve = solved;
+                prevInverse = inverse;
+            }
+        }
+    }
+
+    const std::shared_ptr<const EasingTable> cached = EasingTable::Get({EasingKind::Power, 2});
+    REQUIRE(cached == EasingTable::Get({EasingKind::Power, 2}));
+    REQUIRE_THROWS_AS(EasingTable::Get({EasingKind::Sine, 0})->Solve(1.5, EasingMode::In), std::out_of_range);
+
+    // Distinct parameters beyond the capacity evict the table, so only the caller still holds it.
+    for (std::size_t i = 0; i < EasingTable::CACHE_CAPACITY; ++i) {
+        EasingTable::Get({EasingKind::Power, 3.0 + static_cast<double>(i)});
+    }
+    REQUIRE(cached.use_count() == 1);
+    REQUIRE(cached != EasingTable::Get({EasingKind::Power, 2}));
+}
+
+/**
+ * @test Solves easing functions in batches and compares every value with the per-value path.
+ */
+TEST_CASE("Solve Easing In Batches") {
+    const auto ulp = [](const double v) { return std::abs(std::nextafter(v, 2.0) - v); };
+
+    std::vector<double> inputs(1001);
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+        inputs[i] = static_cast<double>(i * 7919 % inputs.size()) / (inputs.size() - 1);
+    }
+
+    for (const Easing easing: {Easing{EasingKind::Sine, 0}, Easing{EasingKind::Power, 3},
+                               Easing{EasingKind::Circular, 0}, Easing{EasingKind::Circular, 0.4},
+                               Easing{EasingKind::Circular, 1}}) {
+        for (const EasingMode mode: {EasingMode::Linear, EasingMode::In, EasingMode::Out}) {
+            // Odd lengths leave a tail after the last full register.
+            for (const std::size_t n: {std::size_t{0}, std::size_t{3}, inputs.size()}) {
+                const std::span<const double> in(inputs.data(), n);
+                std::vector<double> solved(n);
+                std::vector<double> inverse(n);
+                easing.Solve(in, solved, mode);
+                easing.InverseSolve(in, inverse, mode);
+
+                for (std::size_t i = 0; i < n; ++i) {
+                    const double s = easing.Solve(in[i], mode);
+                    const double v = easing.InverseSolve(in[i], mode);
+                    REQUIRE(std::abs(solved[i] - s) <= Easing::BATCH_MAX_ULPS * ulp(s));
+                    REQUIRE(std::abs(inverse[i] - v) <= Easing::BATCH_MAX_ULPS * ulp(v));
+                }
+            }
+        }
+    }
+
+    std::vector values{0.0, 0.5, 1.5};
+    REQUIRE_THROWS_AS(Easing{}.Solve(values, values, EasingMode::In), std::out_of_range);
+    REQUIRE(values[1] == 0.5);
+}
+
+/**
+ * @test Converts chains on several threads and checks that the output matches a single-threaded run.
+ */
+TEST_CASE("Convert Chains In Parallel") {
+    Config cctx;
+    for (int c = 0; c < 200; ++c) {
+        mgxc::Chain chain;
+        chain.es = {c % 2 ? EasingKind::Sine : EasingKind::Circular, 0.5};
+        for (int i = 0; i < 4; ++i) {
+            chain.emplace_back(i * 100, (c + i * 5) % 16, (c * 7 + i * 90) % 361, EasingMode::In, EasingMode::Out);
+        }
+        cctx.chains.push_back(chain);
+    }
+
+    const auto convert = [&cctx](const unsigned threads) {
+        cctx.threads = threads;
+        Interpolator interpolator(cctx);
+        interpolator.Convert();
+        return interpolator.GetNoteChains();
+    };
+
+    const std::vector<std::vector<MP_NOTEINFO>> serial = convert(1);
+    const std::vector<std::vector<MP_NOTEINFO>> parallel = convert(4);
+    REQUIRE(serial.size() == cctx.chains.size());
+    REQUIRE(parallel.size() == serial.size());
+    for (std::size_t c = 0; c < serial.size(); ++c) {
+        REQUIRE(parallel[c].size() == serial[c].size());
+        for (std::size_t i = 0; i < serial[c].size(); ++i) {
+            const MP_NOTEINFO &a = parallel[c][i];
+            const MP_NOTEINFO &b = serial[c][i];
+            REQUIRE(std::tie(a.longAttr, a.tick, a.x, a.height) == std::tie(b.longAttr, b.tick, b.x, b.height));
+        }
+    }
+
+    // The first invalid chain is reported, however the chains were scheduled.
+    cctx.chains[150].joints.resize(1);
+    cctx.chains[20].joints.resize(1);
+    REQUIRE_THROWS_WITH(convert(4), "Chain [20] must have at least 2 notes");
+}
+
+/**
+ * @test Bounds the notes of every chain of a chart before converting, exactly for linear and single-axis segments,
+ * and rejects a chain that would exceed the limit.
+ */
+TEST_CASE("Estimate Converted Notes") {
+    Config cctx;
+    aff::Parser(cctx).ParseFile(AIRCURVE_AFF_DIR "/2.aff");
+    for (const int snap: {1, 5, 60}) {
+        cctx.snap = snap;
+        Interpolator interpolator(cctx);
+        interpolator.Convert();
+        const Interpolator::Estimate estimate = Interpolator::EstimateOutput(cctx);
+        REQUIRE(estimate.chains == cctx.chains.size());
+
+        std::size_t notes = 0;
+        for (std::size_t i = 0; i < cctx.chains.size(); ++i) {
+            const std::size_t actual = interpolator.GetNoteChains()[i].size();
+            REQUIRE(Interpolator::EstimateNotes(cctx.chains[i], snap) >= actual);
+            notes += actual;
+        }
+        REQUIRE(estimate.notes >= notes);
+        REQUIRE(interpolator.GetThroughput() > 0);
+    }
+
+    mgxc::Chain chain;
+    chain.emplace_back(0, 0, 0, EasingMode::Linear, EasingMode::Linear);
+    chain.emplace_back(960, 8, 100, EasingMode::Linear, EasingMode::Linear);
+    chain.emplace_back(1920, 8, 100, EasingMode::In, EasingMode::In);
+    chain.emplace_back(2880, 8, 300, EasingMode::In, EasingMode::Out);
+    chain.emplace_back(3840, 0, 300, EasingMode::Out, EasingMode::Linear);
+    cctx.chains.assign(1, chain);
+    cctx.snap = 1;
+    Interpolator interpolator(cctx);
+    interpolator.Convert();
+    REQUIRE(Interpolator::EstimateNotes(chain, 1) == 1 + 1 + 1 + 200 + 8);
+    REQUIRE(interpolator.GetNoteChains()[0].size() == Interpolator::EstimateNotes(chain, 1));
+    REQUIRE(Interpolator::EstimateNotes(chain, 240) == 1 + 1 + 1 + 4 + 4);
+    REQUIRE(Interpolator::EstimateOutput(cctx, 3).chains == 0);
+
+    cctx.chains[0][4].x = 2'000'000;
+    cctx.chains[0][4].t = 100'000'000;
+    REQUIRE(Interpolator::EstimateOutput(cctx).largest > Interpolator::MAX_CHAIN_NOTES);
+    REQUIRE_THROWS_WITH(interpolator.Convert(),
+                        "Chain [0] would convert to up to 2000195 notes, more than the limit of 1000000");
+}
+
+/**
+ * @test Drops control notes of long eased chains while the rendered curve stays within the tolerance of the eased
+ * curve, or no further from it than the unsimplified notes, at every tick.
+ */
+TEST_CASE("Simplify Within Tolerance") {
+    Config cctx;
+    mgxc::Chain chain;
+    chain.emplace_back(0, 0, 0, EasingMode::In, EasingMode::Out);
+    chain.emplace_back(7680, 15, 40, EasingMode::Out, EasingMode::In);
+    chain.emplace_back(15360, 0, 0, EasingMode::Linear, EasingMode::Linear);
+    cctx.chains.push_back(chain);
+    chain.joints.clear();
+    chain.es = {EasingKind::Circular, 0};
+    chain.emplace_back(0, 8, 0, EasingMode::Linear, EasingMode::In);
+    chain.emplace_back(3840, 8, 360, EasingMode::Linear, EasingMode::Linear);
+    cctx.chains.push_back(chain);
+
+    Interpolator exact(cctx);
+    exact.Convert();
+    REQUIRE(exact.GetDropped() == 0);
+    cctx.tolerance = 2;
+    Interpolator simplified(cctx);
+    simplified.Convert();
+
+    // Position of the curve the chart draws through the notes, at a tick.
+    const auto rendered = [](const std::vector<MP_NOTEINFO> &notes, const int tick) {
+        const auto next = std::ranges::upper_bound(notes, tick, {}, &MP_NOTEINFO::tick);
+        if (next == notes.end()) {
+            return std::pair<double, double>(notes.back().x, notes.back().height);
+        }
+        const MP_NOTEINFO &prev = *(next - 1);
+        const double f = static_cast<double>(tick - prev.tick) / (next->tick - prev.tick);
+        return std::pair(prev.x + f * (next->x - prev.x), prev.height + f * (next->height - prev.height));
+    };
+
+    std::size_t dropped = 0;
+    for (std::size_t c = 0; c < cctx.chains.size(); ++c) {
+        const mgxc::Chain &joints = cctx.chains[c];
+        const std::vector<MP_NOTEINFO> &all = exact.GetNoteChains()[c];
+        const std::vector<MP_NOTEINFO> &kept = simplified.GetNoteChains()[c];
+        REQUIRE(kept.size() < all.size());
+        REQUIRE(kept.front().longAttr == MP_NOTELONGATTR_BEGIN);
+        REQUIRE(kept.back().longAttr == MP_NOTELONGATTR_END);
+        dropped += all.size() - kept.size();
+
+        for (std::size_t j = 0; j + 1 < joints.size(); ++j) {
+            const mgxc::Joint &curr = joints[j];
+            const mgxc::Joint &next = joints[j + 1];
+            for (int tick = curr.t; tick <= next.t; tick += cctx.snap) {
+                const double u = static_cast<double>(tick - curr.t) / (next.t - curr.t);
+                const double x = curr.x + joints.es.Solve(u, curr.eX) * (next.x - curr.x);
+                const double y = curr.y + joints.es.Solve(u, curr.eY) * (next.y - curr.y);
+                const auto [keptX, keptY] = rendered(kept, tick);
+                const auto [allX, allY] = rendered(all, tick);
+                REQUIRE(std::hypot(keptX - x, keptY - y) <= std::max(2.0, std::hypot(allX - x, allY - y)) + 1e-9);
+            }
+        }
+    }
+    REQUIRE(simplified.GetDropped() == dropped);
+}
+
+/**
+ * @test Chooses control notes that round to the same tick so the drawn curve is closer to the eased one, summed over
+ * every chart tick, than keeping the nearest note at each tick leaves it.
+ */
+TEST_CASE("Sample Segments Optimally") {
+    Config cctx;
+    mgxc::Chain chain;
+    chain.emplace_back(0, 0, 0, EasingMode::Linear, EasingMode::In);
+    chain.emplace_back(100, 0, 360, EasingMode::In, EasingMode::Out);
+    chain.emplace_back(200, 15, 40, EasingMode::Out, EasingMode::Out);
+    chain.emplace_back(240, 3, 300, EasingMode::Linear, EasingMode::Linear);
+    cctx.chains.push_back(chain);
+    cctx.chains.push_back(chain);
+    cctx.chains.back().es = {EasingKind::Circular, 0.5};
+
+    Interpolator greedy(cctx);
+    greedy.Convert();
+    cctx.optimalSampling = true;
+    Interpolator optimal(cctx);
+    optimal.Convert();
+
+    for (std::size_t c = 0; c < cctx.chains.size(); ++c) {
+        const mgxc::Chain &joints = cctx.chains[c];
+        const std::vector<MP_NOTEINFO> &before = greedy.GetNoteChains()[c];
+        const std::vector<MP_NOTEINFO> &after = optimal.GetNoteChains()[c];
+        REQUIRE(after.size() == before.size());
+        REQUIRE(after.front().longAttr == MP_NOTELONGATTR_BEGIN);
+        REQUIRE(after.back().longAttr == MP_NOTELONGATTR_END);
+
+        double greedyTotal = 0;
+        double optimalTotal = 0;
+        for (int tick = joints.front().t; tick <= joints.back().t; ++tick) {
+            greedyTotal += CurveDistance(joints, before, tick);
+            optimalTotal += CurveDistance(joints, after, tick);
+        }
+        REQUIRE(optimalTotal < greedyTotal);
+    }
+
+    ConversionCache cache;
+    Interpolator cached(cctx, &cache);
+    cached.Convert();
+    cctx.optimalSampling = false;
+    cached.Convert();
+    REQUIRE(mgxc::data::Serialize(cached.GetNoteChains()) == mgxc::data::Serialize(greedy.GetNoteChains()));
+}
+
+/**
+ * @test Serializes converted note chains with one header per chain and one line per note.
+ */
+TEST_CASE("Serialize Note Chains") {
+    Config cctx;
+    mgxc::Chain chain;
+    chain.til = 3;
+    chain.emplace_back(0, 0, 0, EasingMode::Linear, EasingMode::Linear);
+    chain.emplace_back(10, 0, 0, EasingMode::Linear, EasingMode::Linear);
+    cctx.chains.push_back(chain);
+    cctx.chains.push_back(chain);
+
+    Interpolator interpolator(cctx);
+    interpolator.Convert();
+    const std::string text = mgxc::data::Serialize(interpolator.GetNoteChains());
+
+    const std::string one = std::format("<{},3>\n{{0,0,4,0,{}}}\n{{10,0,4,0,{}}}\n", MP_NOTETYPE_AIRSLIDE,
+                                        MP_NOTELONGATTR_BEGIN, MP_NOTELONGATTR_END);
+    REQUIRE(text == one + "\n" + one);
+    REQUIRE(mgxc::data::Serialize(std::vector<std::vector<MP_NOTEINFO>>{}).empty());
+}
+
+/**
+ * @test Parses chain text with blanks and CRLF line ends, sorts only out-of-order chains, and reports bad lines.
+ */
+TEST_CASE("Parse Chains In Place") {
+    Config cctx;
+    aff::Parser(cctx).ParseFile(AIRCURVE_AFF_DIR "/2.aff");
+    const std::string text = mgxc::data::Serialize(cctx.chains);
+    REQUIRE(mgxc::data::Serialize(mgxc::data::Parse(text)) == text);
+
+    const std::vector<mgxc::Chain> chains = mgxc::data::Parse("ignored\r\n"
+                                                              "[ 1, +2 ,3,p,0.5]  trailing\r\n"
+                                                              "(20,1,1,i,o)\r\n"
+                                                              "( 10 , -1 , 2 , - , - )\r\n"
+                                                              "(10,5,5,-,-)\r\n"
+                                                              "\r\n"
+                                                              "[1,2,3,s,0]\n"
+                                                              "[1,2,3,c,0]\n"
+                                                              "(0,0,0,-,-)");
+    REQUIRE(chains.size() == 2);
+    REQUIRE(chains[0].width == 2);
+    REQUIRE(chains[0].es.m_kind == EasingKind::Power);
+    REQUIRE(chains[0].es.m_param == 0.5);
+    REQUIRE(chains[0].joints == std::vector{mgxc::Joint(10, -1, 2, EasingMode::Linear, EasingMode::Linear),
+                                            mgxc::Joint(10, 5, 5, EasingMode::Linear, EasingMode::Linear),
+                                            mgxc::Joint(20, 1, 1, EasingMode::In, EasingMode::Out)});
+    REQUIRE(chains[1].es.m_kind == EasingKind::Circular);
+    REQUIRE(chains[1].size() == 1);
+
+    REQUIRE_THROWS_WITH(mgxc::data::Parse("[1,2,3,s,0]\n(0,0,0,-,-)\n(0,0,-,-)\n"),
+                        "Invalid body format at line 3: (0,0,-,-)");
+    REQUIRE_THROWS_WITH(mgxc::data::Parse("\n\n[1,2,x,s,0]\r\n"), "Invalid header format at line 3: [1,2,x,s,0]");
+}
+
+/**
+ * @test Converts chains between the text and binary formats without loss, and rejects damaged binary files.
+ */
+TEST_CASE("Round-Trip Binary Chains") {
+    Config cctx;
+    aff::Parser(cctx).ParseFile(AIRCURVE_AFF_DIR "/2.aff");
+    cctx.chains.front().es = {EasingKind::Circular, 0.1};
+    cctx.chains.back().til = 7;
+
+    const std::string text = mgxc::data::Serialize(cctx.chains);
+    const std::string binary = mgxc::data::SerializeBinary(mgxc::data::Parse(text));
+    REQUIRE(mgxc::data::Serialize(mgxc::data::ParseBinary(binary)) == text);
+    REQUIRE(mgxc::data::SerializeBinary(mgxc::data::ParseBinary(binary)) == binary);
+    REQUIRE(mgxc::data::ParseBinary(binary).front().es.m_param == 0.1);
+    REQUIRE(mgxc::data::ParseBinary(mgxc::data::SerializeBinary({})).empty());
+
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "aircurve-test.mgxb";
+    {
+        std::ofstream out(path, std::ios::binary);
+        out.write(binary.data(), static_cast<std::streamsize>(binary.size()));
+    }
+    REQUIRE(mgxc::data::Serialize(mgxc::data::LoadBinary(path.string())) == text);
+    std::filesystem::remove(path);
+
+    std::string damaged = binary.substr(0, binary.size() - 1);
+    REQUIRE_THROWS_WITH(mgxc::data::ParseBinary(damaged), Catch::Matchers::StartsWith("Invalid chain file: "));
+    damaged = binary;
+    damaged[4] = 2;
+    REQUIRE_THROWS_WITH(mgxc::data::ParseBinary(damaged), "Invalid chain file: version 2 is not supported");
+    damaged = binary;
+    damaged.back() = 'x';
+    REQUIRE_THROWS_WITH(mgxc::data::ParseBinary(damaged), Catch::Matchers::EndsWith("has an unknown easing mode"));
+    REQUIRE_THROWS_WITH(mgxc::data::ParseBinary("MGXC"), "Invalid chain file: missing header");
+}
+
+/**
+ * @test Commits note chains through a ChartWriter, and discards the batch when a write fails.
+ */
+TEST_CASE("Commit Through Chart Writer") {
+    struct Collect final : mgxc::ChartWriter {
+        std::vector<std::vector<MP_NOTEINFO>> written;
+        std::string calls;
+        bool fail{false};
+
+        void Begin() override { calls += 'b'; }
+        void Write(const std::span<const MP_NOTEINFO> noteChain) override {
+            if (fail && !written.empty()) {
+                throw std::runtime_error("Write failed");
+            }
+            calls += 'w';
+            written.emplace_back(noteChain.begin(), noteChain.end());
+        }
+        void Commit() override { calls += 'c'; }
+        void Discard() override { calls += 'd'; }
+    };
+
+    Config cctx;
+    mgxc::Chain chain;
+    chain.emplace_back(0, 0, 0, EasingMode::Linear, EasingMode::Linear);
+    chain.emplace_back(100, 8, 200, EasingMode::Linear, EasingMode::Linear);
+    cctx.chains.push_back(chain);
+    cctx.chains.push_back(chain);
+
+    Interpolator interpolator(cctx);
+    Collect empty;
+    interpolator.Commit(empty);
+    REQUIRE(empty.calls.empty());
+
+    interpolator.Convert();
+    Collect writer;
+    interpolator.Commit(writer);
+    REQUIRE(writer.calls == "bwwc");
+    REQUIRE(writer.written.size() == 2);
+    REQUIRE(writer.written[1].size() == interpolator.GetNoteChains()[1].size());
+
+    Collect failing;
+    failing.fail = true;
+    REQUIRE_THROWS_WITH(interpolator.Commit(failing), "Write failed");
+    REQUIRE(failing.calls == "bwd");
+}
+
+/**
+ * @test Builds one note tree per chain through the plugin interfaces, and drops them when the commit is discarded.
+ */
+TEST_CASE("Commit Through Mock Margrete") {
+    Config cctx;
+    mgxc::Chain chain;
+    chain.emplace_back(0, 0, 0, EasingMode::Linear, EasingMode::Linear);
+    chain.emplace_back(100, 8, 200, EasingMode::Linear, EasingMode::Linear);
+    cctx.chains.push_back(chain);
+    chain.type = MP_NOTETYPE_AIRCRUSH;
+    cctx.chains.push_back(chain);
+
+    Interpolator interpolator(cctx);
+    interpolator.Convert();
+    const std::vector<MP_NOTEINFO> &slide = interpolator.GetNoteChains()[0];
+    const std::vector<MP_NOTEINFO> &crush = interpolator.GetNoteChains()[1];
+    REQUIRE(slide.size() == 2);
+
+    mgxc::mock::Margrete mg;
+    mgxc::ComChartWriter writer(mg);
+    interpolator.Commit(writer);
+
+    // The air slide hangs off a tap and an air note; the air crush is appended as it is.
+    const mgxc::mock::CallCounts &calls = mg.GetCalls();
+    REQUIRE(calls.createNote == slide.size() + 2 + crush.size());
+    REQUIRE(calls.setInfo == calls.createNote);
+    REQUIRE(calls.appendChild == slide.size() + 1 + crush.size() - 1);
+    REQUIRE(calls.appendNote == 2);
+    REQUIRE(calls.getChart == 1);
+    REQUIRE(calls.beginRecording == 1);
+    REQUIRE(calls.commitRecording == 1);
+    REQUIRE(calls.update == 1);
+    REQUIRE(mg.GetUndoSteps() == 1);
+
+    const std::vector<mgxc::mock::Note *> &roots = mg.GetChartState().GetNotes();
+    REQUIRE(roots.size() == 2);
+    REQUIRE(roots[0]->GetInfo().type == MP_NOTETYPE_TAP);
+    const mgxc::mock::Note *air = roots[0]->GetChildren().at(0);
+    REQUIRE(air->GetInfo().type == MP_NOTETYPE_AIR);
+    const mgxc::mock::Note *head = air->GetChildren().at(0);
+    REQUIRE(head->GetInfo().tick == slide[0].tick);
+    REQUIRE(head->GetChildren().size() == slide.size() - 1);
+    REQUIRE(head->GetChildren()[0]->GetInfo().x == slide[1].x);
+    REQUIRE(roots[1]->GetInfo().type == MP_NOTETYPE_AIRCRUSH);
+    REQUIRE(mg.GetChartState().CountNotes() == calls.createNote);
+    REQUIRE(writer.GetStats().notes == calls.createNote);
+    REQUIRE(writer.GetStats().calls == calls.createNote + calls.setInfo + calls.appendChild + calls.appendNote);
+
+    const MP_NOTEINFO orphan{};
+    REQUIRE_THROWS_WITH(writer.Write(std::span(&orphan, 1)), "ComChartWriter::Write called outside Begin and Commit");
+
+    struct Failing final : mgxc::ChartWriter {
+        mgxc::ComChartWriter<mgxc::mock::Margrete> inner;
+        explicit Failing(const mgxc::mock::Margrete &mg) : inner(mg) {}
+        void Begin() override { inner.Begin(); }
+        void Write(const std::span<const MP_NOTEINFO> noteChain) override {
+            inner.Write(noteChain);
+            throw std::runtime_error("Write failed");
+        }
+        void Commit() override { inner.Commit(); }
+        void Discard() override { inner.Discard(); }
+    };
+
+    Failing failing(mg);
+    REQUIRE_THROWS_WITH(interpolator.Commit(failing), "Write failed");
+    REQUIRE(mg.GetCalls().discardRecording == 1);
+    REQUIRE(mg.GetChartState().GetNotes().size() == 2);
+    REQUIRE(mg.GetUndoSteps() == 1);
+}
+
+/**
+ * @test Converts on a background thread with progress, fails and cancels without the UI, and commits only once done.
+ */
+TEST_CASE("Convert In Background") {
+    Config cctx;
+    cctx.threads = 2;
+    mgxc::Chain chain;
+    chain.emplace_back(0, 0, 0, EasingMode::In, EasingMode::Out);
+    chain.emplace_back(960, 12, 200, EasingMode::Out, EasingMode::In);
+    cctx.chains.assign(200, chain);
+
+    Interpolator reference(cctx);
+    reference.Convert();
+
+    ConversionJob job(cctx);
+    REQUIRE(job.GetTotal() == 200);
+    cctx.chains.clear(); // The job converts its own copy.
+    job.Wait();
+    REQUIRE(job.GetState() == ConversionJob::State::Done);
+    REQUIRE(job.GetDone() == 200);
+    REQUIRE(job.GetProgress() == 1.0f);
+    REQUIRE(job.GetInterpolator().GetNoteChains().size() == 200);
+    REQUIRE(job.GetInterpolator().GetNoteChains()[199].size() == reference.GetNoteChains()[199].size());
+
+    mgxc::mock::Margrete mg;
+    mgxc::ComChartWriter writer(mg);
+    REQUIRE(job.Commit(writer));
+    REQUIRE(mg.GetChartState().GetNotes().size() == 200);
+
+    cctx.chains.assign(3, chain);
+    cctx.chains[1].joints.pop_back();
+    ConversionJob failing(cctx);
+    failing.Wait();
+    REQUIRE(failing.GetState() == ConversionJob::State::Failed);
+    REQUIRE_THROWS_WITH(failing.Commit(writer), "Chain [1] must have at least 2 notes");
+
+    // Enough work that the job cannot finish before the cancel lands.
+    mgxc::Chain dense;
+    for (int i = 0; i <= 2000; ++i) {
+        dense.emplace_back(i * 960, i % 16, i % 2 * 300, EasingMode::In, EasingMode::Out);
+    }
+    cctx.chains.assign(200, dense);
+
+    // Cancelled mid-conversion, once the first chain is done: each worker finishes its chain and takes no more.
+    ConversionJob cancelled(cctx);
+    while (cancelled.GetDone() == 0 && !cancelled.IsFinished()) {
+        std::this_thread::yield();
+    }
+    cancelled.Cancel();
+    cancelled.Wait();
+    REQUIRE(cancelled.GetState() == ConversionJob::State::Cancelled);
+    REQUIRE(cancelled.GetDone() > 0);
+    REQUIRE(cancelled.GetDone() <= cancelled.GetTotal() / 2);
+    REQUIRE(cancelled.GetInterpolator().GetNoteChains().empty());
+    REQUIRE_FALSE(cancelled.Commit(writer));
+    REQUIRE(mg.GetCalls().beginRecording == 1);
+
+    std::stop_source plugin;
+    ConversionJob stopped(cctx, -1, plugin.get_token());
+    plugin.request_stop();
+    stopped.Wait();
+    REQUIRE(stopped.GetState() == ConversionJob::State::Cancelled);
+}
+
+/**
+ * @test Reconverts only chains whose joints or settings changed, with output identical to an uncached conversion.
+ */
+TEST_CASE("Reuse Cached Conversions") {
+    Config cctx;
+    mgxc::Chain chain;
+    chain.emplace_back(0, 0, 0, EasingMode::In, EasingMode::Out);
+    chain.emplace_back(960, 12, 200, EasingMode::Out, EasingMode::In);
+    cctx.chains.assign(4, chain);
+    for (int i = 0; i < 4; ++i) {
+        cctx.chains[i][1].t += i * 480;
+    }
+
+    ConversionCache cache;
+    Interpolator cached(cctx, &cache);
+    cached.Convert();
+    REQUIRE(cache.GetStats().hits == 0);
+    REQUIRE(cache.GetStats().misses == 4);
+    REQUIRE(cache.GetStats().entries == 4);
+
+    const auto same = [&] {
+        Interpolator plain(cctx);
+        plain.Convert();
+        const std::vector<std::vector<MP_NOTEINFO>> &expected = plain.GetNoteChains();
+        const std::vector<std::vector<MP_NOTEINFO>> &actual = cached.GetNoteChains();
+        REQUIRE(actual.size() == expected.size());
+        for (std::size_t i = 0; i < expected.size(); ++i) {
+            REQUIRE(actual[i].size() == expected[i].size());
+            for (std::size_t j = 0; j < expected[i].size(); ++j) {
+                REQUIRE(std::memcmp(&actual[i][j], &expected[i][j], sizeof(MP_NOTEINFO)) == 0);
+            }
+        }
+    };
+
+    cache.ResetStats();
+    cctx.chains[2][1].x = 5;
+    cctx.chains[3].es = {EasingKind::Power, 2};
+    cached.Convert();
+    REQUIRE(cache.GetStats().hits == 2);
+    REQUIRE(cache.GetStats().misses == 2);
+    same();
+
+    cache.ResetStats();
+    cctx.xOffset = 1;
+    cached.Convert();
+    REQUIRE(cache.GetStats().hits == 0);
+    same();
+
+    cache.ResetStats();
+    cached.Convert(1);
+    REQUIRE(cache.GetStats().hits == 1);
+    REQUIRE(cached.GetNoteChains().size() == 1);
+
+    // A key shared with other inputs, as a hash collision would be, is a miss rather than another chain's notes.
+    const std::uint64_t key = ConversionCache::Key(cctx.chains[0], cctx);
+    REQUIRE(cache.Find(key, cctx.chains[0], cctx) != nullptr);
+    REQUIRE(cache.Find(key, cctx.chains[1], cctx) == nullptr);
+    cctx.chains[0][0].eX = EasingMode::Linear;
+    REQUIRE(cache.Find(key, cctx.chains[0], cctx) == nullptr);
+    cctx.chains[0][0].eX = EasingMode::In;
+
+    // Over capacity, entries the last conversion did not use are dropped.
+    ConversionCache small(4);
+    Interpolator pruned(cctx, &small);
+    cctx.xOffset = 0;
+    pruned.Convert();
+    cctx.xOffset = 2;
+    pruned.Convert();
+    REQUIRE(small.GetStats().entries == 4);
+}
+
+/**
+ * @test Converts a chart again on the same session without allocating, and gives the same notes as a fresh conversion.
+ */
+TEST_CASE("Convert Again Without Allocating") {
+    Config cctx;
+    cctx.threads = 1;
+    for (int c = 0; c < 50; ++c) {
+        mgxc::Chain chain;
+        for (int i = 0; i < 6; ++i) {
+            chain.emplace_back(c * 10 + i * 480, (c + i * 5) % 16, (c * 7 + i * 90) % 360, EasingMode::In,
+                               EasingMode::Out);
+        }
+        cctx.chains.push_back(chain);
+    }
+
+    const auto count = [](ConversionSession &session, const Config &next) {
+        const std::size_t before = utils::CountThreadAllocations();
+        session.Begin(next).Convert();
+        return utils::CountThreadAllocations() - before;
+    };
+
+    // The same chart, new settings, then a smaller chart with an edited joint.
+    ConversionSession session;
+    session.Begin(cctx).Convert();
+    REQUIRE(count(session, cctx) == 0);
+    cctx.xOffset = 1;
+    REQUIRE(count(session, cctx) == 0);
+    cctx.chains.resize(20);
+    cctx.chains[3][2].x = 0;
+    REQUIRE(count(session, cctx) == 0);
+
+    // Every chain from the cache; only storing new entries allocates.
+    ConversionCache cache;
+    ConversionSession cached(&cache);
+    cached.Begin(cctx).Convert();
+    REQUIRE(count(cached, cctx) == 0);
+    REQUIRE(cache.GetStats().hits == 20);
+
+    Interpolator fresh(cctx);
+    fresh.Convert();
+    const std::vector<std::vector<MP_NOTEINFO>> &expected = fresh.GetNoteChains();
+    const std::vector<std::vector<MP_NOTEINFO>> &actual = session.GetInterpolator().GetNoteChains();
+    REQUIRE(actual.size() == expected.size());
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        REQUIRE(actual[i].size() == expected[i].size());
+        REQUIRE(std::memcmp(actual[i].data(), expected[i].data(), actual[i].size() * sizeof(MP_NOTEINFO)) == 0);
+    }
+
+    ConversionJob job(session, cctx, 3);
+    job.Wait();
+    REQUIRE(job.GetState() == ConversionJob::State::Done);
+    REQUIRE(&job.GetInterpolator() == &session.GetInterpolator());
+    REQUIRE(job.GetInterpolator().GetNoteChains().size() == 1);
+}
+
+/**
+ * @test Sorts a chain by tick and reports where a followed joint moved, keeping equal ticks in order.
+ */
+TEST_CASE("Sort Chain Following A Joint") {
+    static_assert(std::is_trivially_copyable_v<mgxc::Joint>);
+
+    mgxc::Chain chain;
+    chain.emplace_back(960, 0, 0, EasingMode::Linear, EasingMode::Linear);
+    chain.emplace_back(0, 1, 0, EasingMode::Linear, EasingMode::Linear);
+    chain.emplace_back(480, 2, 0, EasingMode::Linear, EasingMode::Linear);
+    chain.emplace_back(480, 3, 0, EasingMode::Linear, EasingMode::Linear);
+
+    mgxc::Chain copy = chain;
+    REQUIRE(copy.sort(0) == 3);
+    REQUIRE(copy[3].x == 0);
+
+    for (std::size_t track = 0; track < chain.size(); ++track) {
+        copy = chain;
+        const std::size_t moved = copy.sort(track);
+        REQUIRE(copy[moved].x == chain[track].x);
+    }
+    REQUIRE(copy[1].x == 2);
+    REQUIRE(copy[2].x == 3);
+}
+
+/**
+ * @test Merges and inserts joints into a sorted chain as appending, skipping duplicates and sorting would, and finds
+ * free ticks.
+ */
+TEST_CASE("Merge Joints Into A Chain") {
+    mgxc::Chain chain;
+    for (int i = 0; i < 200; ++i) {
+        chain.emplace_back(i / 3 * 10, i % 7, 0, EasingMode::Linear, EasingMode::Linear);
+    }
+    std::vector<mgxc::Joint> pasted;
+    for (int i = 0; i < 300; ++i) {
+        pasted.emplace_back((i * 37) % 700, i % 5, 0, EasingMode::In, EasingMode::Out);
+    }
+
+    mgxc::Chain expected = chain;
+    for (const mgxc::Joint &joint : pasted) {
+        if (std::ranges::find(expected, joint) == expected.end()) {
+            expected.push_back(joint);
+        }
+    }
+    expected.sort();
+
+    mgxc::Chain merged = chain;
+    REQUIRE(merged.Merge(pasted) == expected.size() - chain.size());
+    REQUIRE(std::ranges::equal(merged, expected, [](const mgxc::Joint &a, const mgxc::Joint &b) {
+        return a == b && a.eX == b.eX && a.eY == b.eY;
+    }));
+    REQUIRE(merged.Merge(pasted) == 0);
+
+    for (const std::size_t track : {std::size_t{0}, std::size_t{57}, chain.size() - 1}) {
+        merged = chain;
+        const std::size_t moved = merged.Merge(pasted, track);
+        REQUIRE(merged.size() == expected.size());
+        REQUIRE(merged[moved] == chain[track]);
+        REQUIRE(merged[moved].eX == EasingMode::Linear);
+    }
+
+    const std::size_t inserted = chain.Insert(mgxc::Joint(10, 9, 9, EasingMode::In, EasingMode::In));
+    REQUIRE(inserted == 6);
+    REQUIRE(chain[inserted].x == 9);
+    REQUIRE(chain.Insert(mgxc::Joint(-5, 0, 0, EasingMode::In, EasingMode::In)) == 0);
+    REQUIRE(std::ranges::is_sorted(chain, {}, &mgxc::Joint::t));
+
+    REQUIRE(chain.FindFreeTick(0, 5) == 5);
+    REQUIRE(chain.FindFreeTick(0, 10) == 670);
+    REQUIRE(chain.FindFreeTick(-5, 10) == 5);
+    REQUIRE(chain.FindFreeTick(3, 10) == 3);
+}
+
+/**
+ * @test Recomputes only the preview segments next to an edited joint, and spreads long chains over several updates.
+ */
+TEST_CASE("Preview Recomputes Dirty Segments") {
+    mgxc::Chain chain;
+    for (int i = 0; i < 8; ++i) {
+        chain.emplace_back(i * 480, i % 16, i * 40, EasingMode::In, EasingMode::Out);
+    }
+
+    mgxc::ChainPreview preview;
+    REQUIRE(preview.Update(chain, std::chrono::seconds(1)));
+    REQUIRE(preview.GetSegmentCount() == 7);
+    REQUIRE(preview.GetRecomputed() == 7);
+    for (std::size_t i = 0; i < preview.GetSegmentCount(); ++i) {
+        const std::span<const mgxc::ChainPreview::Point> segment = preview.GetSegment(i);
+        REQUIRE(segment.front().t == chain[i].t);
+        REQUIRE(segment.front().x == chain[i].x);
+        REQUIRE(segment.back().t == chain[i + 1].t);
+        REQUIRE(segment.back().y == chain[i + 1].y);
+    }
+
+    REQUIRE(preview.Update(chain, std::chrono::seconds(1)));
+    REQUIRE(preview.GetRecomputed() == 0);
+
+    chain[3].x = 15;
+    REQUIRE(preview.Update(chain, std::chrono::seconds(1)));
+    REQUIRE(preview.GetRecomputed() == 2);
+    REQUIRE(preview.GetSegment(2).back().x == 15);
+    REQUIRE(preview.GetSegment(3).front().x == 15);
+
+    chain[0].eY = EasingMode::Linear;
+    REQUIRE(preview.Update(chain, std::chrono::seconds(1)));
+    REQUIRE(preview.GetRecomputed() == 1);
+
+    chain.es = {EasingKind::Power, 3};
+    REQUIRE(preview.Update(chain, std::chrono::seconds(1)));
+    REQUIRE(preview.GetRecomputed() == 7);
+
+    mgxc::Chain longChain;
+    for (int i = 0; i < 20000; ++i) {
+        longChain.emplace_back(i * 12, i % 16, i % 360, EasingMode::In, EasingMode::Out);
+    }
+    REQUIRE_FALSE(preview.Update(longChain, std::chrono::steady_clock::duration::zero()));
+    REQUIRE(preview.GetDirtyCount() > 0);
+    REQUIRE(preview.GetDirtyCount() < preview.GetSegmentCount());
+    while (!preview.Update(longChain, std::chrono::steady_clock::duration::zero())) {
+        REQUIRE(preview.GetRecomputed() > 0);
+    }
+    REQUIRE(preview.GetDirtyCount() == 0);
+    REQUIRE(preview.GetSegment(19998).back().t == longChain[19999].t);
+}
+
+/**
+ * @test Logs summaries at info level and per-note dumps only at trace level, and nothing without a sink.
+ */
+TEST_CASE("Log Conversion Summaries") {
+    struct Capture final : logging::Sink {
+        std::vector<std::pair<logging::Level, std::string>> messages;
+        void Write(const logging::Level level, const std::string_view message) override {
+            messages.emplace_back(level, message);
+        }
+    };
+
+    Config cctx;
+    mgxc::Chain chain;
+    chain.emplace_back(0, 0, 0, EasingMode::Linear, EasingMode::Linear);
+    chain.emplace_back(100, 8, 200, EasingMode::Linear, EasingMode::Linear);
+    cctx.chains.push_back(chain);
+    Interpolator interpolator(cctx);
+
+    const auto capture = std::make_shared<Capture>();
+    logging::SetSink(capture);
+    logging::SetLevel(logging::Level::Info);
+    interpolator.Convert();
+    REQUIRE(capture->messages.size() == 1);
+    REQUIRE(capture->messages[0].first == logging::Level::Info);
+    REQUIRE_THAT(capture->messages[0].second, Catch::Matchers::StartsWith("Interpolated 1 chains into "));
+
+    capture->messages.clear();
+    logging::SetLevel(logging::Level::Trace);
+    interpolator.Convert();
+    REQUIRE(capture->messages.size() == 2);
+    REQUIRE(capture->messages[1].first == logging::Level::Trace);
+    REQUIRE_THAT(capture->messages[1].second, Catch::Matchers::ContainsSubstring("a=1, t=0, x=0, h=0"));
+
+    capture->messages.clear();
+    logging::SetSink(nullptr);
+    REQUIRE_FALSE(logging::IsEnabled(logging::Level::Error));
+    interpolator.Convert();
+    REQUIRE(capture->messages.empty());
+    logging::SetLevel(logging::Level::Info);
+}
+
 /**
  * @test Shows the dialog once and checks for successful display.
  */
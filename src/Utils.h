@@ -1,7 +1,12 @@
 #pragma once
 #include <array>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <ranges>
 #include <stdexcept>
 #include <type_traits>
+#include <utility>
 
 namespace utils {
     /**
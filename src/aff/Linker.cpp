@@ -0,0 +1,112 @@
+#include <functional>
+
+#include "Linker.h"
+
+namespace aff {
+    namespace {
+        constexpr void HashCombine(std::size_t &seed, const std::size_t value) noexcept {
+            seed ^= value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+        }
+    } // namespace
+
+    std::size_t Linker::KeyHash::operator()(const Key &key) const noexcept {
+        std::size_t seed = std::hash<int>{}(key.t);
+        HashCombine(seed, std::hash<int>{}(key.x));
+        HashCombine(seed, std::hash<int>{}(key.y));
+        HashCombine(seed, std::hash<int>{}(key.type));
+        HashCombine(seed, static_cast<std::size_t>(key.trace));
+        return seed;
+    }
+
+    Linker::Linker(const std::vector<Arc> &arcs) :
+        m_arcs(arcs), m_handled(arcs.size(), false), m_startNext(arcs.size(), NONE), m_endNext(arcs.size(), NONE) {
+        m_starts.reserve(arcs.size());
+        m_ends.reserve(arcs.size());
+
+        // Walk backwards and prepend, so every list ends up in ascending index order.
+        for (std::size_t i = arcs.size(); i-- > 0;) {
+            const auto [start, newStart] = m_starts.try_emplace(StartOf(arcs[i]), i);
+            if (!newStart) {
+                m_startNext[i] = start->second;
+                start->second = i;
+            }
+
+            const auto [end, newEnd] = m_ends.try_emplace(EndOf(arcs[i]), i);
+            if (!newEnd) {
+                m_endNext[i] = end->second;
+                end->second = i;
+            }
+        }
+    }
+
+    std::size_t Linker::Find(Index &index, std::vector<std::size_t> &next, const Key &key, std::size_t &second) {
+        second = NONE;
+
+        const auto it = index.find(key);
+        if (it == index.end()) {
+            return NONE;
+        }
+
+        std::size_t first = NONE;
+        std::size_t *link = &it->second;
+        while (*link != NONE) {
+            const std::size_t j = *link;
+            if (m_handled[j]) {
+                // Handled arcs never match again, so drop them to keep later scans short.
+                *link = next[j];
+                continue;
+            }
+
+            if (first == NONE) {
+                first = j;
+            } else {
+                second = j;
+                break;
+            }
+            link = &next[j];
+        }
+        return first;
+    }
+
+    bool Linker::LinkArc(std::vector<Arc> &chain) {
+        std::size_t second;
+        const std::size_t linkIndex = Find(m_starts, m_startNext, EndOf(chain.back()), second);
+
+        if (linkIndex == NONE || second != NONE) {
+            return false;
+        }
+
+        chain.push_back(m_arcs[linkIndex]);
+        m_handled[linkIndex] = true;
+        return true;
+    }
+
+    bool Linker::HasPrecedingArc(const Arc &arc) {
+        std::size_t second;
+        return Find(m_ends, m_endNext, StartOf(arc), second) != NONE;
+    }
+
+    std::vector<std::vector<Arc>> Linker::Link() {
+        std::vector<std::vector<Arc>> chains;
+
+        for (std::size_t i = 0; i < m_arcs.size(); ++i) {
+            if (m_handled[i] || HasPrecedingArc(m_arcs[i])) {
+                continue;
+            }
+
+            std::vector<Arc> chain;
+
+            chain.push_back(m_arcs[i]);
+            m_handled[i] = true;
+
+            bool found;
+            do {
+                found = LinkArc(chain);
+            } while (found);
+
+            chains.push_back(std::move(chain));
+        }
+
+        return chains;
+    }
+} // namespace aff
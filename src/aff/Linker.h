@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+#include "Arc.h"
+
+namespace aff {
+    /**
+     * @class Linker
+     * @brief Links parsed arcs into chains using a hash index over arc endpoints.
+     *
+     * Arcs are indexed once by their start point and by their end point, keyed on (t, x, y, type, trace),
+     * so successor and predecessor lookups run in expected O(1) and a whole chart links in near-linear time.
+     */
+    class Linker {
+    public:
+        /**
+         * @brief Builds the endpoint index over the given arcs.
+         * @param arcs Arcs in file order. Must outlive the Linker.
+         */
+        explicit Linker(const std::vector<Arc> &arcs);
+
+        /**
+         * @brief Links all arcs into chains.
+         *
+         * A chain starts at every arc without an unlinked predecessor and grows while exactly one unlinked arc
+         * continues it. A chain stops when more than one candidate matches.
+         *
+         * @return Linked arc chains in order of their first arc.
+         */
+        std::vector<std::vector<Arc>> Link();
+
+    private:
+        /**
+         * @struct Key
+         * @brief Identifies an arc endpoint.
+         */
+        struct Key {
+            int t{0};
+            int x{0};
+            int y{0};
+            int type{0};
+            bool trace{false};
+
+            friend bool operator==(const Key &, const Key &) = default;
+        };
+
+        /**
+         * @struct KeyHash
+         * @brief Hash functor for endpoint keys.
+         */
+        struct KeyHash {
+            std::size_t operator()(const Key &key) const noexcept;
+        };
+
+        /** Maps an endpoint to the first arc of an intrusive list of arcs sharing it, in ascending index order. */
+        using Index = std::unordered_map<Key, std::size_t, KeyHash>;
+
+        static constexpr std::size_t NONE = static_cast<std::size_t>(-1);
+
+        const std::vector<Arc> &m_arcs; /**< Arcs being linked. */
+        std::vector<bool> m_handled; /**< Flags indicating if arcs have been linked. */
+
+        Index m_starts; /**< Arcs grouped by start point. */
+        std::vector<std::size_t> m_startNext; /**< Next arc with the same start point. */
+        Index m_ends; /**< Arcs grouped by end point. */
+        std::vector<std::size_t> m_endNext; /**< Next arc with the same end point. */
+
+        static Key StartOf(const Arc &arc) noexcept { return {arc.t, arc.x, arc.y, arc.type, arc.trace}; }
+        static Key EndOf(const Arc &arc) noexcept { return {arc.toT, arc.toX, arc.toY, arc.type, arc.trace}; }
+
+        /**
+         * @brief Finds up to two unhandled arcs in a bucket, unlinking handled arcs on the way.
+         * @param index Index owning the bucket.
+         * @param next Successor links for the index.
+         * @param key Endpoint to look up.
+         * @param second Receives the second unhandled arc, or NONE.
+         * @return The first unhandled arc, or NONE.
+         */
+        std::size_t Find(Index &index, std::vector<std::size_t> &next, const Key &key, std::size_t &second);
+
+        /**
+         * @brief Attempts to extend a chain by its unique successor.
+         * @param chain The chain to extend.
+         * @return True if an arc was appended.
+         */
+        bool LinkArc(std::vector<Arc> &chain);
+        /**
+         * @brief Checks if an unhandled arc ends where the given arc starts.
+         * @param arc The arc to check.
+         * @return True if a preceding arc exists.
+         */
+        bool HasPrecedingArc(const Arc &arc);
+    };
+} // namespace aff
@@ -1,80 +1,163 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <format>
 #include <fstream>
-#include <iostream>
-#include <sstream>
+#include <iterator>
+#include <stdexcept>
+#include <tuple>
 
 #include "Arc.h"
+#include "Linker.h"
+#include "Log.h"
+#include "MappedFile.h"
+#include "Parallel.h"
 #include "Parser.h"
 #include "Primitive.h"
 
 namespace aff {
     namespace {
-        std::vector<std::string> Split(const std::string &text, const char delimiter) {
-            std::vector<std::string> parts;
-            std::stringstream stream(text);
-            std::string part;
-            while (getline(stream, part, delimiter)) {
-                parts.push_back(part);
+        int ToIntOrThrow(const std::string_view str) {
+            int value;
+            if (!ToInt(str, value)) {
+                throw std::invalid_argument(std::format("Invalid integer '{}'", str));
             }
-            return parts;
+            return value;
         }
-    } // namespace
 
-    void Parser::ParseSingle(const std::string &str) {
-        const size_t start = str.find('(');
-        const size_t end = str.rfind(')');
-        if (start == std::string::npos || end == std::string::npos) {
-            throw std::invalid_argument("Invalid arc format - missing parentheses");
+        double ToDoubleOrThrow(const std::string_view str) {
+            double value;
+            if (!ToDouble(str, value)) {
+                throw std::invalid_argument(std::format("Invalid number '{}'", str));
+            }
+            return value;
         }
+    } // namespace
 
-        const std::string content = str.substr(start + 1, end - start - 1);
-        const std::vector<std::string> parts = Split(content, ',');
+    Parser::Parser(Config &m_cctx) : m_cctx(m_cctx) {}
 
-        if (parts.size() < 10) {
+    void Parser::ParseSingle(const Event &event) {
+        if (event.argc < 10) {
             throw std::invalid_argument("Invalid arc format - not enough parameters");
         }
 
-        Arc arc;
+        const auto &parts = event.args;
+
+        PendingArc pending;
+        pending.loc = event.loc;
+
+        Arc &arc = pending.arc;
         arc.t = ParseT(parts[0]);
         arc.toT = ParseT(parts[1]);
         if (arc.Duration() < 0) {
             throw std::invalid_argument("Invalid arc format - time length must be positive");
         }
-        if (arc.Duration() == 0) {
-            arc.toT = arc.t + m_cctx.snap;
-        }
         arc.x = ParseX(parts[2]);
         arc.toX = ParseX(parts[3]);
         arc.y = ParseY(parts[5]);
         arc.toY = ParseY(parts[6]);
-        arc.type = stoi(parts[7]);
+        arc.type = ToIntOrThrow(parts[7]);
         arc.trace = parts[9] != "false";
 
-        const int len = arc.Duration();
-        if (len >= 2 && parts[4] == "b") {
-            Arc first = arc;
-            first.toT = arc.t + len / 2;
-            first.toX = (arc.x + arc.toX) / 2;
-            first.toY = (arc.y + arc.toY) / 2;
-            ParseArcEasing(first, "so");
-
-            Arc second = arc;
-            second.t = first.toT;
-            second.x = first.toX;
-            second.y = first.toY;
-            ParseArcEasing(second, "si");
-
-            m_arcs.push_back(first);
-            m_arcs.push_back(second);
-        } else {
+        pending.split = parts[4] == "b";
+        if (!pending.split) {
             ParseArcEasing(arc, parts[4]);
-            m_arcs.push_back(arc);
         }
+
+        m_groups[m_current].pending.push_back(pending);
+    }
+
+    void Parser::ConvertPendingArcs(Group &group) const {
+        std::vector<PendingArc> &pending = group.pending;
+        const TimingMap &timing = group.timing;
+
+        std::vector<int> ms(pending.size());
+        std::vector<int> ticks(pending.size());
+
+        // Charts list arcs by start time, so start times usually convert in one merge over the timing map.
+        const auto convert = [&](int Arc::*field) {
+            std::ranges::transform(pending, ms.begin(), [field](const PendingArc &p) { return p.arc.*field; });
+            if (std::ranges::is_sorted(ms)) {
+                timing.ToTicks(ms, ticks);
+            } else {
+                std::ranges::transform(ms, ticks.begin(), [&timing](const int t) { return timing.ToTick(t); });
+            }
+            for (std::size_t i = 0; i < pending.size(); ++i) {
+                pending[i].arc.*field = ticks[i];
+            }
+        };
+        convert(&Arc::t);
+        convert(&Arc::toT);
+
+        std::vector<Arc> &arcs = group.arcs;
+        arcs.reserve(pending.size());
+        for (PendingArc &p: pending) {
+            Arc &arc = p.arc;
+            if (arc.Duration() < 0) {
+                group.diagnostics.push_back({p.loc, "arc(...): Invalid arc format - time length must be positive"});
+                continue;
+            }
+            if (arc.Duration() == 0) {
+                arc.toT = arc.t + m_cctx.snap;
+            }
+
+            const int len = arc.Duration();
+            if (len >= 2 && p.split) {
+                Arc first = arc;
+                first.toT = arc.t + len / 2;
+                first.toX = (arc.x + arc.toX) / 2;
+                first.toY = (arc.y + arc.toY) / 2;
+                ParseArcEasing(first, "so");
+
+                Arc second = arc;
+                second.t = first.toT;
+                second.x = first.toX;
+                second.y = first.toY;
+                ParseArcEasing(second, "si");
+
+                arcs.push_back(first);
+                arcs.push_back(second);
+            } else {
+                arcs.push_back(arc);
+            }
+        }
+    }
+
+    void Parser::BuildGroups() {
+        const TimingMap &main = m_groups.front().timing;
+        for (Group &group: m_groups) {
+            // A group without its own timing follows the main timeline, which is always built first.
+            if (&group != &m_groups.front() && group.timing.Empty()) {
+                group.timing = main;
+            } else {
+                group.timing.Build();
+            }
+        }
+
+        utils::parallel_for(
+                m_groups.size(),
+                [this](const std::size_t i, unsigned) {
+                    Group &group = m_groups[i];
+                    ConvertPendingArcs(group);
+                    group.chains = Linker(group.arcs).Link();
+                },
+                m_cctx.threads);
+
+        for (Group &group: m_groups) {
+            m_diagnostics.insert(m_diagnostics.end(), group.diagnostics.begin(), group.diagnostics.end());
+        }
+        std::ranges::stable_sort(m_diagnostics, [](const Diagnostic &a, const Diagnostic &b) {
+            return std::tie(a.loc.line, a.loc.column) < std::tie(b.loc.line, b.loc.column);
+        });
     }
 
     void Parser::ResetState() {
-        m_archains.clear();
-        m_arcs.clear();
-        m_handled.clear();
+        m_groups.clear();
+        m_groups.emplace_back(mgxc::BEAT_TICKS);
+        m_current = 0;
+        m_diagnostics.clear();
+        m_stages = {};
     }
 
     void Parser::AppendChainsToConfig() const {
@@ -82,26 +165,39 @@ namespace aff {
             m_cctx.chains.clear();
         }
 
-        for (const std::vector<Arc> &archain: m_archains) {
-            if (archain.empty()) {
+        // Each group that yields chains gets its own timeline, starting from the configured TIL.
+        MpInteger til = m_cctx.til;
+        for (const Group &group: m_groups) {
+            if (group.chains.empty()) {
                 continue;
             }
 
-            mgxc::Chain chain;
-            chain.width = m_cctx.width;
-            chain.til = m_cctx.til;
-            chain.type = archain.front().trace ? MP_NOTETYPE_AIRCRUSH : MP_NOTETYPE_AIRSLIDE;
-
-            for (std::size_t i = 0; i < archain.size(); ++i) {
-                const Arc &arc = archain[i];
-                chain.emplace_back(arc.t, arc.x, arc.y, arc.eX, arc.eY);
-                if (i == archain.size() - 1) {
-                    chain.emplace_back(arc.toT, arc.toX, arc.toY, arc.eX, arc.eY);
-                }
+            for (const std::vector<Arc> &archain: group.chains) {
+                AppendChainToConfig(archain, til);
             }
+            til = std::min(til + 1, mgxc::MAX_TIL);
+        }
+    }
+
+    void Parser::AppendChainToConfig(const std::vector<Arc> &archain, const MpInteger til) const {
+        if (archain.empty()) {
+            return;
+        }
+
+        mgxc::Chain chain;
+        chain.width = m_cctx.width;
+        chain.til = til;
+        chain.type = archain.front().trace ? MP_NOTETYPE_AIRCRUSH : MP_NOTETYPE_AIRSLIDE;
 
-            m_cctx.chains.push_back(std::move(chain));
+        for (std::size_t i = 0; i < archain.size(); ++i) {
+            const Arc &arc = archain[i];
+            chain.emplace_back(arc.t, arc.x, arc.y, arc.eX, arc.eY);
+            if (i == archain.size() - 1) {
+                chain.emplace_back(arc.toT, arc.toX, arc.toY, arc.eX, arc.eY);
+            }
         }
+
+        m_cctx.chains.push_back(std::move(chain));
     }
 
     void Parser::ParseArcEasing(Arc &arc, const std::string_view easing) {
@@ -131,160 +227,140 @@ namespace aff {
         }
     }
 
-    int Parser::ParseT(const std::string &str) const {
-        const int time = std::stoi(str);
-        const double ticks = time / (60000.0 / m_bpm) * mgxc::BEAT_TICKS;
-        return static_cast<int>(std::round(ticks));
-    }
+    int Parser::ParseT(const std::string_view str) { return ToIntOrThrow(str); }
 
-    int Parser::ParseX(const std::string &str) {
-        const double x = std::stod(str);
+    int Parser::ParseX(const std::string_view str) {
+        const double x = ToDoubleOrThrow(str);
         constexpr double start = -0.2;
         constexpr double step = 0.1;
         return static_cast<int>(std::floor((x - start) / step));
     }
 
-    int Parser::ParseY(const std::string &str) {
-        const double y = std::stod(str);
+    int Parser::ParseY(const std::string_view str) {
+        const double y = ToDoubleOrThrow(str);
         return static_cast<int>(y * 100.0);
     }
 
-    void Print(const Config &cctx) {
-        std::cout << "Parsed " << cctx.chains.size() << std::endl;
-        int i = 0;
-        for (const mgxc::Chain &chain: cctx.chains) {
-            std::cout << i++ << ":" << std::endl;
-            for (const mgxc::Joint &joint: chain) {
-                std::cout << "  t=" << joint.t << ", x=" << joint.x << ", y=" << joint.y
-                          << ", eX=" << static_cast<int>(joint.eX) << ", eY=" << static_cast<int>(joint.eY)
-                          << std::endl;
-            }
-        }
-    }
+    void Parser::Parse(const std::string_view text) {
+        using Clock = std::chrono::steady_clock;
 
-    void Parser::Parse(const std::string &str) {
         ResetState();
 
-        ParseString(str);
-        if (m_arcs.empty()) {
-            throw std::runtime_error("No arcs found in the chart");
-        }
+        auto start = Clock::now();
+        ParseString(text);
+        auto end = Clock::now();
+        m_stages.tokenize = end - start;
 
-        for (size_t i = 0; i < m_arcs.size(); ++i) {
-            if (m_handled[i] || HasPrecedingArc(m_arcs[i])) {
-                continue;
-            }
-
-            std::vector<Arc> chain;
-
-            chain.push_back(m_arcs[i]);
-            m_handled[i] = true;
-
-            bool found;
-            do {
-                found = LinkArc(chain);
-            } while (found);
+        start = end;
+        BuildGroups();
+        end = Clock::now();
+        m_stages.link = end - start;
 
-            if (!chain.empty()) {
-                m_archains.push_back(std::move(chain));
-            }
+        if (std::ranges::all_of(m_groups, [](const Group &group) { return group.arcs.empty(); })) {
+            throw std::runtime_error("No arcs found in the chart");
         }
 
+        const std::size_t first = m_cctx.append ? m_cctx.chains.size() : 0;
+        start = end;
         AppendChainsToConfig();
+        m_stages.append = Clock::now() - start;
 
-        Print(m_cctx);
-    }
-
-    void Parser::ParseFile(const std::string &filePath) {
-        std::ifstream file(filePath);
-        if (!file.is_open()) {
-            throw std::invalid_argument("Could not open file: " + filePath);
+        if (logging::IsEnabled<logging::Level::Info>()) {
+            LogChains(std::span(m_cctx.chains).subspan(first));
         }
-
-        const std::string content((std::istreambuf_iterator(file)), (std::istreambuf_iterator<char>()));
-        Parse(content);
     }
 
-    bool Parser::LinkArc(std::vector<Arc> &chain) {
-        const Arc &lastArc = chain.back();
-        size_t linkCount = 0;
-        size_t linkIndex = m_arcs.size();
-
-        for (size_t j = 0; j < m_arcs.size(); ++j) {
-            if (m_handled[j]) {
-                continue;
-            }
+    void Parser::LogChains(const std::span<const mgxc::Chain> chains) const {
+        std::size_t joints = 0;
+        std::size_t longest = 0;
+        std::size_t shortest = chains.empty() ? 0 : SIZE_MAX;
+        for (const mgxc::Chain &chain: chains) {
+            joints += chain.size();
+            longest = std::max(longest, chain.size());
+            shortest = std::min(shortest, chain.size());
+        }
 
-            if (const Arc &candidate = m_arcs[j]; lastArc.CanLinkWith(candidate)) {
-                linkCount++;
-                if (linkIndex == m_arcs.size()) {
-                    linkIndex = j;
+        using Ms = std::chrono::duration<double, std::milli>;
+        logging::Log<logging::Level::Info>(
+                "Parsed {} chains, {} joints from {} timing groups in {:.3f} ms (tokenize {:.3f}, link {:.3f}, append "
+                "{:.3f}); joints per chain {}..{}; {} skipped",
+                chains.size(), joints, m_groups.size(), Ms(m_stages.Total()).count(), Ms(m_stages.tokenize).count(),
+                Ms(m_stages.link).count(), Ms(m_stages.append).count(), shortest, longest, m_diagnostics.size());
+
+        if (logging::IsEnabled<logging::Level::Trace>()) {
+            for (std::size_t i = 0; i < chains.size(); ++i) {
+                std::string text = std::format("Chain {}:", i);
+                for (const mgxc::Joint &joint: chains[i]) {
+                    std::format_to(std::back_inserter(text), "\n  t={}, x={}, y={}, eX={}, eY={}", joint.t, joint.x,
+                                   joint.y, static_cast<int>(joint.eX), static_cast<int>(joint.eY));
                 }
+                logging::Log<logging::Level::Trace>("{}", text);
             }
         }
+    }
 
-        if (linkCount > 1) {
-            return false;
+    void Parser::ParseFile(const std::string &filePath) {
+        if (utils::MappedFile mapped; mapped.Open(filePath)) {
+            Parse(mapped.View());
+            return;
         }
 
-        if (linkCount == 1) {
-            chain.push_back(m_arcs[linkIndex]);
-            m_handled[linkIndex] = true;
-            return true;
+        std::ifstream file(filePath, std::ios::binary);
+        if (!file.is_open()) {
+            throw std::invalid_argument("Could not open file: " + filePath);
         }
 
-        return false;
+        const std::string content((std::istreambuf_iterator(file)), (std::istreambuf_iterator<char>()));
+        Parse(content);
     }
 
-    bool Parser::HasPrecedingArc(const Arc &arc) {
-        for (size_t j = 0; j < m_arcs.size(); ++j) {
-            if (m_handled[j]) {
-                continue;
-            }
-            if (m_arcs[j].CanLinkWith(arc)) {
-                return true;
-            }
+    void Parser::ParseTiming(const Event &event) {
+        if (event.argc < 3) {
+            throw std::invalid_argument("Invalid timing format - not enough parameters");
         }
-        return false;
-    }
-
-    void Parser::ParseBpm(const std::string &token) {
-        if (token.rfind("timing(", 0) == 0) {
-            std::string content = token.substr(7);
-            content.erase(content.find(')'));
 
-            std::vector<double> params;
-            for (const std::string &param: Split(content, ',')) {
-                params.push_back(std::stod(param));
-            }
-
-            if (params.size() >= 3 && params[0] == 0) {
-                m_bpm = params[1];
-            }
-        }
+        m_groups[m_current].timing.Add(ParseT(event.args[0]), ToDoubleOrThrow(event.args[1]));
     }
 
-    void Parser::ParseString(const std::string &str) {
-        std::stringstream ss(str);
-        std::string token;
-
-        while (getline(ss, token, ';')) {
-            std::erase_if(token, [](const auto c) { return ::isspace(c); });
-            ParseBpm(token);
-        }
-
-        ss.clear();
-        ss.str(str);
-
-        while (getline(ss, token, ';')) {
-            std::erase_if(token, [](const auto c) { return ::isspace(c); });
+    void Parser::ParseString(const std::string_view text) {
+        Tokenizer tokenizer(text);
+        Event event;
+        int depth = 0;
+
+        while (tokenizer.Next(event)) {
+            switch (event.kind) {
+                case Event::Kind::Error:
+                    m_diagnostics.push_back({event.loc, std::string(event.name)});
+                    continue;
+                case Event::Kind::BlockBegin:
+                    if (depth == 0 && event.name == "timinggroup") {
+                        m_groups.emplace_back(mgxc::BEAT_TICKS);
+                        m_current = m_groups.size() - 1;
+                    } else {
+                        m_diagnostics.push_back({event.loc, "Unexpected block"});
+                    }
+                    ++depth;
+                    continue;
+                case Event::Kind::BlockEnd:
+                    if (depth == 0) {
+                        m_diagnostics.push_back({event.loc, "Unmatched '}'"});
+                    } else if (--depth == 0) {
+                        m_current = 0;
+                    }
+                    continue;
+                case Event::Kind::Call:
+                    break;
+            }
 
-            if (token.rfind("arc(", 0) == 0) {
-                try {
-                    ParseSingle(token);
-                } catch (...) { continue; }
+            try {
+                if (event.name == "timing") {
+                    ParseTiming(event);
+                } else if (event.name == "arc") {
+                    ParseSingle(event);
+                }
+            } catch (const std::exception &e) {
+                m_diagnostics.push_back({event.loc, std::format("{}(...): {}", event.name, e.what())});
             }
         }
-        m_handled.resize(m_arcs.size(), false);
     }
 } // namespace aff
@@ -1,18 +1,49 @@
 #pragma once
 
+#include <chrono>
+#include <cstddef>
+#include <span>
 #include <string>
 #include <string_view>
 #include <vector>
 
 #include "Arc.h"
 #include "Config.h"
+#include "Timing.h"
+#include "Tokenizer.h"
 
 namespace aff {
+    /**
+     * @struct Diagnostic
+     * @brief Describes a malformed statement that was skipped while parsing.
+     */
+    struct Diagnostic {
+        Location loc; /**< Location of the statement. */
+        std::string message; /**< Description of the problem. */
+    };
+
+    /**
+     * @struct ParseStages
+     * @brief Wall time spent in each stage of a parse.
+     */
+    struct ParseStages {
+        std::chrono::steady_clock::duration tokenize{}; /**< Tokenizing statements and sorting them into groups. */
+        std::chrono::steady_clock::duration link{}; /**< Converting arc times to ticks and linking chains. */
+        std::chrono::steady_clock::duration append{}; /**< Appending the linked chains to the configuration. */
+
+        /**
+         * @brief Gets the time of the whole parse.
+         * @return Sum of the stage times.
+         */
+        std::chrono::steady_clock::duration Total() const noexcept { return tokenize + link + append; }
+    };
+
     /**
      * @class Parser
      * @brief Parses .aff files and strings into arc chains for the plugin.
      *
      * Manages arc parsing, chain linking, and provides parsing utilities for BPM, T, X, and Y values.
+     * Every timing group keeps its own tempo and arcs and is linked independently, on its own TIL.
      */
     class Parser {
     public:
@@ -20,82 +51,122 @@ namespace aff {
          * @brief Constructs a Parser with a reference to the configuration context.
          * @param m_cctx Reference to the plugin configuration context.
          */
-        explicit Parser(Config &m_cctx) : m_cctx(m_cctx) {}
+        explicit Parser(Config &m_cctx);
 
         /**
          * @brief Parses an .aff file from the given file path.
+         *
+         * The file is memory-mapped and parsed in place where supported, falling back to reading it into memory.
+         *
          * @param filePath Path to the .aff file.
          */
         void ParseFile(const std::string &filePath);
         /**
          * @brief Parses .aff data from a string.
-         * @param str The string containing .aff data.
+         * @param text The string containing .aff data.
+         */
+        void Parse(std::string_view text);
+
+        /**
+         * @brief Gets the malformed statements skipped by the last parse.
+         * @return Diagnostics in order of appearance.
+         */
+        const std::vector<Diagnostic> &GetDiagnostics() const noexcept { return m_diagnostics; }
+        /**
+         * @brief Gets the time spent in each stage of the last parse.
+         * @return Stage times; stages a failed parse did not reach are zero.
          */
-        void Parse(const std::string &str);
+        const ParseStages &GetStages() const noexcept { return m_stages; }
 
     private:
-        /** Current BPM value for parsing. */
-        double m_bpm{100};
+        /**
+         * @struct PendingArc
+         * @brief An arc whose times are still in milliseconds, waiting for the timing map.
+         */
+        struct PendingArc {
+            Arc arc; /**< The arc, with t and toT in milliseconds. */
+            bool split{false}; /**< Whether the arc is split into an out/in pair once converted. */
+            Location loc; /**< Location of the statement. */
+        };
+
+        /**
+         * @struct Group
+         * @brief A timeline of the chart: the main timeline or one `timinggroup(...){ ... }` block.
+         */
+        struct Group {
+            explicit Group(const int beatTicks) : timing(beatTicks) {}
+
+            TimingMap timing; /**< Tempo changes local to the group. */
+            std::vector<PendingArc> pending; /**< Arcs read from the group, in file order. */
+            std::vector<Arc> arcs; /**< Arcs converted to ticks. */
+            std::vector<std::vector<Arc>> chains; /**< Linked arc chains. */
+            std::vector<Diagnostic> diagnostics; /**< Problems found while converting the group. */
+        };
+
         /** Reference to the plugin configuration context. */
         Config &m_cctx;
 
-        /** List of parsed arcs. */
-        std::vector<Arc> m_arcs;
-        /** List of arc chains. */
-        std::vector<std::vector<Arc>> m_archains;
-        /** Flags indicating if arcs have been handled. */
-        std::vector<bool> m_handled;
+        /** Timelines of the chart; the first is the main timeline. */
+        std::vector<Group> m_groups;
+        /** Index of the group receiving statements while tokenizing. */
+        std::size_t m_current{0};
+        /** Malformed statements skipped while parsing. */
+        std::vector<Diagnostic> m_diagnostics;
+        /** Time spent in each stage of the last parse. */
+        ParseStages m_stages;
 
         /**
-         * @brief Parses a single arc or line from a string.
-         * @param str The string to parse.
+         * @brief Parses a single arc statement.
+         * @param event The `arc(...)` statement.
          */
-        void ParseSingle(const std::string &str);
-        void ResetState();
-        void AppendChainsToConfig() const;
-        void ParseArcEasing(Arc &arc, std::string_view easing);
-
+        void ParseSingle(const Event &event);
+        /**
+         * @brief Converts a group's pending arcs to ticks through its timing map.
+         * @param group The group to convert.
+         */
+        void ConvertPendingArcs(Group &group) const;
         /**
-         * @brief Attempts to link arcs into a chain.
-         * @param chain The chain to link.
-         * @return True if linking was successful.
+         * @brief Builds the timing maps of all groups and links every group's chains on a worker pool.
          */
-        bool LinkArc(std::vector<Arc> &chain);
+        void BuildGroups();
+        void ResetState();
+        void AppendChainsToConfig() const;
+        void AppendChainToConfig(const std::vector<Arc> &archain, MpInteger til) const;
         /**
-         * @brief Checks if an arc has a preceding arc in the chain.
-         * @param arc The arc to check.
-         * @return True if a preceding arc exists.
+         * @brief Logs a summary of the parsed chains, and every joint at trace level.
+         * @param chains Chains added by the parse.
          */
-        bool HasPrecedingArc(const Arc &arc);
+        void LogChains(std::span<const mgxc::Chain> chains) const;
+        static void ParseArcEasing(Arc &arc, std::string_view easing);
 
         /**
-         * @brief Parses BPM from a token string.
-         * @param token The token containing BPM information.
+         * @brief Adds a tempo change from a timing statement.
+         * @param event The `timing(...)` statement.
          */
-        void ParseBpm(const std::string &token);
+        void ParseTiming(const Event &event);
         /**
-         * @brief Parses a string for arc data.
-         * @param str The string to parse.
+         * @brief Tokenizes a string and sorts its arc and timing data into groups.
+         * @param text The string to parse.
          */
-        void ParseString(const std::string &str);
+        void ParseString(std::string_view text);
         /**
-         * @brief Parses a T (tick) value from a string.
+         * @brief Parses a T (time) value from a string.
          * @param str The string to parse.
-         * @return The parsed tick value.
+         * @return The parsed time in milliseconds.
          */
-        int ParseT(const std::string &str) const;
+        static int ParseT(std::string_view str);
         /**
          * @brief Parses an X value from a string.
          * @param str The string to parse.
          * @return The parsed X value.
          */
-        static int ParseX(const std::string &str);
+        static int ParseX(std::string_view str);
         /**
          * @brief Parses a Y value from a string.
          * @param str The string to parse.
          * @return The parsed Y value.
          */
-        static int ParseY(const std::string &str);
+        static int ParseY(std::string_view str);
     };
 
 } // namespace aff
@@ -0,0 +1,67 @@
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <stdexcept>
+
+#include "Timing.h"
+
+namespace aff {
+    TimingMap::TimingMap(const int beatTicks) : m_beatTicks(beatTicks) {}
+
+    void TimingMap::Add(const int ms, const double bpm) { m_segments.push_back({ms, bpm, 0}); }
+
+    void TimingMap::Clear() { m_segments.clear(); }
+
+    void TimingMap::Build() {
+        if (m_segments.empty()) {
+            m_segments.push_back({0, DEFAULT_BPM, 0});
+            return;
+        }
+
+        std::ranges::stable_sort(m_segments, {}, &Segment::ms);
+
+        // Keep only the last change at each time, so a lookup never lands on a shadowed segment.
+        const auto last = std::ranges::unique(m_segments.rbegin(), m_segments.rend(), {}, &Segment::ms);
+        m_segments.erase(m_segments.begin(), last.begin().base());
+
+        // The first segment anchors tick 0 at time 0, extrapolating its tempo backwards if it starts later.
+        Segment &first = m_segments.front();
+        first.tick = first.ms * first.bpm / 60000.0 * m_beatTicks;
+        for (std::size_t i = 1; i < m_segments.size(); ++i) {
+            const Segment &prev = m_segments[i - 1];
+            m_segments[i].tick = prev.tick + (m_segments[i].ms - prev.ms) * prev.bpm / 60000.0 * m_beatTicks;
+        }
+    }
+
+    int TimingMap::ToTick(const Segment &segment, const int ms) const {
+        const double ticks = segment.tick + (ms - segment.ms) * segment.bpm / 60000.0 * m_beatTicks;
+        return static_cast<int>(std::round(ticks));
+    }
+
+    int TimingMap::ToTick(const int ms) const {
+        if (m_segments.empty()) {
+            throw std::logic_error("TimingMap must be built before converting");
+        }
+
+        const auto it = std::ranges::upper_bound(m_segments, ms, {}, &Segment::ms);
+        const Segment &segment = it == m_segments.begin() ? m_segments.front() : *std::prev(it);
+        return ToTick(segment, ms);
+    }
+
+    void TimingMap::ToTicks(const std::span<const int> ms, const std::span<int> ticks) const {
+        if (m_segments.empty()) {
+            throw std::logic_error("TimingMap must be built before converting");
+        }
+        if (ticks.size() < ms.size()) {
+            throw std::invalid_argument("Output span is shorter than input span");
+        }
+
+        std::size_t seg = 0;
+        for (std::size_t i = 0; i < ms.size(); ++i) {
+            while (seg + 1 < m_segments.size() && m_segments[seg + 1].ms <= ms[i]) {
+                ++seg;
+            }
+            ticks[i] = ToTick(m_segments[seg], ms[i]);
+        }
+    }
+} // namespace aff
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+namespace aff {
+    /**
+     * @class TimingMap
+     * @brief Converts chart times in milliseconds to ticks across tempo changes.
+     *
+     * Collects `timing(...)` events, sorts them once and prefix-accumulates the tick offset of every tempo
+     * segment, so a single conversion is a binary search and a sorted batch is a single linear merge.
+     */
+    class TimingMap {
+    public:
+        /** BPM assumed when a chart declares no timing. */
+        static constexpr double DEFAULT_BPM = 100.0;
+
+        /**
+         * @brief Constructs an empty TimingMap.
+         * @param beatTicks Number of ticks in a beat.
+         */
+        explicit TimingMap(int beatTicks);
+
+        /**
+         * @brief Adds a tempo change. Call Build() before converting.
+         * @param ms Time of the change in milliseconds.
+         * @param bpm Tempo from that time on.
+         */
+        void Add(int ms, double bpm);
+        /**
+         * @brief Sorts the tempo changes and accumulates their tick offsets.
+         *
+         * Later changes at the same time override earlier ones. Without any change, DEFAULT_BPM applies from 0.
+         */
+        void Build();
+        /**
+         * @brief Removes all tempo changes.
+         */
+        void Clear();
+        /**
+         * @brief Checks if no tempo change has been added.
+         * @return True if the map is empty.
+         */
+        bool Empty() const noexcept { return m_segments.empty(); }
+
+        /**
+         * @brief Converts a time to ticks in O(log k) for k tempo changes.
+         * @param ms Time in milliseconds.
+         * @return The time in ticks, rounded to the nearest tick.
+         */
+        int ToTick(int ms) const;
+        /**
+         * @brief Converts a batch of ascending times to ticks with a single linear merge.
+         * @param ms Times in milliseconds, sorted in ascending order.
+         * @param ticks Receives the times in ticks. Must be as long as ms.
+         */
+        void ToTicks(std::span<const int> ms, std::span<int> ticks) const;
+
+    private:
+        /**
+         * @struct Segment
+         * @brief A span of constant tempo.
+         */
+        struct Segment {
+            int ms{0}; /**< Start time in milliseconds. */
+            double bpm{DEFAULT_BPM}; /**< Tempo of the segment. */
+            double tick{0}; /**< Start time in ticks. */
+        };
+
+        double m_beatTicks; /**< Number of ticks in a beat. */
+        std::vector<Segment> m_segments; /**< Tempo segments, sorted by start time once built. */
+
+        int ToTick(const Segment &segment, int ms) const;
+    };
+} // namespace aff
@@ -0,0 +1,258 @@
+#include <algorithm>
+#include <charconv>
+#include <system_error>
+
+#include "Tokenizer.h"
+
+namespace aff {
+    namespace {
+        constexpr bool IsSpace(const char c) noexcept {
+            return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+        }
+
+        constexpr bool IsNameChar(const char c) noexcept {
+            return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+        }
+
+        constexpr std::string_view Trim(std::string_view str) noexcept {
+            while (!str.empty() && IsSpace(str.front())) {
+                str.remove_prefix(1);
+            }
+            while (!str.empty() && IsSpace(str.back())) {
+                str.remove_suffix(1);
+            }
+            return str;
+        }
+
+        template<class T>
+        bool FromChars(std::string_view str, T &value) noexcept {
+            if (!str.empty() && str.front() == '+') {
+                str.remove_prefix(1);
+            }
+
+            const char *end = str.data() + str.size();
+            const auto [ptr, ec] = std::from_chars(str.data(), end, value);
+            return !str.empty() && ec == std::errc{} && ptr == end;
+        }
+    } // namespace
+
+    Tokenizer::Tokenizer(const std::string_view text) : m_text(text) {
+        if (m_text.starts_with("\xEF\xBB\xBF")) {
+            m_pos = 3;
+            m_lineStart = 3;
+        }
+        SkipHeader();
+    }
+
+    void Tokenizer::Advance() noexcept {
+        if (m_text[m_pos++] == '\n') {
+            ++m_line;
+            m_lineStart = m_pos;
+        }
+    }
+
+    void Tokenizer::SkipHeader() noexcept {
+        std::size_t pos = m_pos;
+        std::size_t line = m_line;
+
+        while (pos < m_text.size()) {
+            std::size_t eol = m_text.find('\n', pos);
+            if (eol == std::string_view::npos) {
+                eol = m_text.size();
+            }
+
+            const std::string_view content = m_text.substr(pos, eol - pos);
+            if (content.find_first_of("(;{}") != std::string_view::npos) {
+                // Reached statements without a separator line, so there is no header.
+                return;
+            }
+
+            pos = eol + 1;
+            if (Trim(content) == "-") {
+                m_pos = (std::min)(pos, m_text.size());
+                m_line = line + 1;
+                m_lineStart = m_pos;
+                return;
+            }
+            ++line;
+        }
+    }
+
+    void Tokenizer::SkipWhitespace() noexcept {
+        while (!AtEnd() && IsSpace(Peek())) {
+            Advance();
+        }
+    }
+
+    void Tokenizer::Recover() noexcept {
+        while (!AtEnd()) {
+            const char c = Peek();
+            if (c == '{' || c == '}') {
+                return;
+            }
+            Advance();
+            if (c == ';') {
+                return;
+            }
+        }
+    }
+
+    bool Tokenizer::Fail(Event &event, const std::string_view message, const Location loc) {
+        event.kind = Event::Kind::Error;
+        event.name = message;
+        event.argc = 0;
+        event.suffix = {};
+        event.loc = loc;
+        Recover();
+        return true;
+    }
+
+    bool Tokenizer::ReadArgs(Event &event) {
+        // Called just past '('; reads up to and including the matching ')'.
+        int depth = 0;
+        bool quoted = false;
+        std::size_t argStart = m_pos;
+
+        const auto pushArg = [&event, this, &argStart] {
+            if (event.argc < Event::MAX_ARGS) {
+                event.args[event.argc] = Trim(m_text.substr(argStart, m_pos - argStart));
+            }
+            ++event.argc;
+        };
+
+        while (!AtEnd()) {
+            const char c = Peek();
+            if (quoted) {
+                quoted = c != '"';
+            } else if (c == '"') {
+                quoted = true;
+            } else if (c == '(') {
+                ++depth;
+            } else if (c == ')') {
+                if (depth == 0) {
+                    pushArg();
+                    Advance();
+                    if (event.argc == 1 && event.args[0].empty()) {
+                        event.argc = 0;
+                    }
+                    return true;
+                }
+                --depth;
+            } else if (c == ',' && depth == 0) {
+                pushArg();
+                argStart = m_pos + 1;
+            } else if (c == ';' || c == '{' || c == '}') {
+                return false;
+            }
+            Advance();
+        }
+        return false;
+    }
+
+    bool Tokenizer::ReadSuffix(Event &event) {
+        // Called on '['; reads up to and including the matching ']'.
+        Advance();
+        const std::size_t start = m_pos;
+        int depth = 0;
+
+        while (!AtEnd()) {
+            const char c = Peek();
+            if (c == '[') {
+                ++depth;
+            } else if (c == ']') {
+                if (depth == 0) {
+                    event.suffix = m_text.substr(start, m_pos - start);
+                    Advance();
+                    return true;
+                }
+                --depth;
+            } else if (c == ';' || c == '{' || c == '}') {
+                return false;
+            }
+            Advance();
+        }
+        return false;
+    }
+
+    bool Tokenizer::Next(Event &event) {
+        using enum Event::Kind;
+
+        for (;;) {
+            SkipWhitespace();
+            if (AtEnd()) {
+                return false;
+            }
+
+            event.name = {};
+            event.argc = 0;
+            event.suffix = {};
+            event.loc = Here();
+
+            switch (Peek()) {
+                case ';':
+                    Advance();
+                    continue;
+                case '{':
+                    Advance();
+                    event.kind = BlockBegin;
+                    return true;
+                case '}':
+                    Advance();
+                    event.kind = BlockEnd;
+                    return true;
+                default:
+                    break;
+            }
+
+            const std::size_t nameStart = m_pos;
+            while (!AtEnd() && IsNameChar(Peek())) {
+                Advance();
+            }
+            if (m_pos == nameStart) {
+                return Fail(event, "Unexpected character", event.loc);
+            }
+            event.name = m_text.substr(nameStart, m_pos - nameStart);
+
+            SkipWhitespace();
+            if (AtEnd() || Peek() != '(') {
+                return Fail(event, "Expected '(' after statement name", Here());
+            }
+            Advance();
+
+            if (!ReadArgs(event)) {
+                return Fail(event, "Missing ')'", Here());
+            }
+
+            SkipWhitespace();
+            if (!AtEnd() && Peek() == '[' && !ReadSuffix(event)) {
+                return Fail(event, "Missing ']'", Here());
+            }
+
+            SkipWhitespace();
+            if (AtEnd()) {
+                event.kind = Call;
+                return true;
+            }
+
+            switch (Peek()) {
+                case ';':
+                    Advance();
+                    event.kind = Call;
+                    return true;
+                case '{':
+                    Advance();
+                    event.kind = BlockBegin;
+                    return true;
+                case '}':
+                    event.kind = Call;
+                    return true;
+                default:
+                    return Fail(event, "Expected ';'", Here());
+            }
+        }
+    }
+
+    bool ToInt(const std::string_view str, int &value) noexcept { return FromChars(str, value); }
+
+    bool ToDouble(const std::string_view str, double &value) noexcept { return FromChars(str, value); }
+} // namespace aff
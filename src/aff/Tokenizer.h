@@ -0,0 +1,102 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string_view>
+
+namespace aff {
+    /**
+     * @struct Location
+     * @brief A 1-based line/column position in an .aff buffer.
+     */
+    struct Location {
+        std::size_t line{1}; /**< Line number. */
+        std::size_t column{1}; /**< Column number in bytes. */
+    };
+
+    /**
+     * @struct Event
+     * @brief A single statement read from an .aff buffer.
+     *
+     * All views point into the tokenized buffer and stay valid as long as it does.
+     */
+    struct Event {
+        /** Maximum number of arguments kept per event. */
+        static constexpr std::size_t MAX_ARGS = 16;
+
+        /**
+         * @enum Kind
+         * @brief Enumerates the kinds of statements.
+         */
+        enum class Kind {
+            Call, /**< A statement such as `arc(...);`. */
+            BlockBegin, /**< A statement opening a block, such as `timinggroup(...){`. */
+            BlockEnd, /**< A closing `}`. */
+            Error, /**< A malformed statement; `name` holds the message. */
+        };
+
+        Kind kind{Kind::Call}; /**< Kind of the statement. */
+        std::string_view name; /**< Statement name, or the error message for Kind::Error. */
+        std::array<std::string_view, MAX_ARGS> args{}; /**< Whitespace-trimmed arguments. */
+        std::size_t argc{0}; /**< Number of arguments, which may exceed MAX_ARGS. */
+        std::string_view suffix; /**< Bracketed suffix such as `[arctap(...)]`, without brackets. */
+        Location loc; /**< Location of the statement. */
+    };
+
+    /**
+     * @class Tokenizer
+     * @brief Single-pass, allocation-free tokenizer over an .aff buffer.
+     *
+     * Skips the `key:value` header up to the `-` separator line, then yields one Event per statement.
+     * Malformed statements are reported as Kind::Error events and skipped up to the next `;`.
+     */
+    class Tokenizer {
+    public:
+        /**
+         * @brief Constructs a Tokenizer over the given buffer.
+         * @param text The buffer to tokenize. Must outlive the Tokenizer and the events it yields.
+         */
+        explicit Tokenizer(std::string_view text);
+
+        /**
+         * @brief Reads the next statement.
+         * @param event Receives the statement.
+         * @return False once the end of the buffer is reached.
+         */
+        bool Next(Event &event);
+
+    private:
+        std::string_view m_text; /**< Buffer being tokenized. */
+        std::size_t m_pos{0}; /**< Current offset into the buffer. */
+        std::size_t m_line{1}; /**< Current line number. */
+        std::size_t m_lineStart{0}; /**< Offset of the current line. */
+
+        bool AtEnd() const noexcept { return m_pos >= m_text.size(); }
+        char Peek() const noexcept { return m_text[m_pos]; }
+        Location Here() const noexcept { return {m_line, m_pos - m_lineStart + 1}; }
+
+        void Advance() noexcept;
+        void SkipHeader() noexcept;
+        void SkipWhitespace() noexcept;
+        void Recover() noexcept;
+
+        bool ReadArgs(Event &event);
+        bool ReadSuffix(Event &event);
+        bool Fail(Event &event, std::string_view message, Location loc);
+    };
+
+    /**
+     * @brief Parses a whole string as an integer.
+     * @param str The string to parse.
+     * @param value Receives the parsed value.
+     * @return True if the whole string is a valid integer.
+     */
+    bool ToInt(std::string_view str, int &value) noexcept;
+    /**
+     * @brief Parses a whole string as a floating-point number.
+     * @param str The string to parse.
+     * @param value Receives the parsed value.
+     * @return True if the whole string is a valid number.
+     */
+    bool ToDouble(std::string_view str, double &value) noexcept;
+} // namespace aff
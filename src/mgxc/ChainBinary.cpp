@@ -0,0 +1,172 @@
+#include "ChainBinary.h"
+
+#include <bit>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+
+#include "MappedFile.h"
+
+namespace mgxc::data {
+    namespace {
+        static_assert(std::endian::native == std::endian::little, "Binary chain files are read and written in place");
+        static_assert(sizeof(MpInteger) == 4);
+
+        constexpr char MAGIC[4] = {'M', 'G', 'X', 'B'};
+        constexpr std::size_t HEADER_SIZE = 16;
+        constexpr std::size_t ENTRY_SIZE = 32;
+        constexpr std::size_t JOINT_SIZE = 3 * sizeof(MpInteger) + 2;
+
+        template<class T>
+        void Put(char *out, const T value) noexcept {
+            std::memcpy(out, &value, sizeof(T));
+        }
+
+        template<class T>
+        T Get(const char *in) noexcept {
+            T value;
+            std::memcpy(&value, in, sizeof(T));
+            return value;
+        }
+
+        [[noreturn]] void Invalid(const std::string_view reason) {
+            throw std::invalid_argument(std::format("Invalid chain file: {}", reason));
+        }
+
+        bool IsKind(const char c) noexcept {
+            return c == static_cast<char>(EasingKind::Sine) || c == static_cast<char>(EasingKind::Power) ||
+                   c == static_cast<char>(EasingKind::Circular);
+        }
+
+        bool IsMode(const char c) noexcept {
+            return c == static_cast<char>(EasingMode::Linear) || c == static_cast<char>(EasingMode::In) ||
+                   c == static_cast<char>(EasingMode::Out);
+        }
+    } // namespace
+
+    std::string SerializeBinary(const std::vector<Chain> &chains) {
+        std::size_t joints = 0;
+        for (const Chain &chain: chains) {
+            joints += chain.size();
+        }
+        if (chains.size() > std::numeric_limits<std::uint32_t>::max() ||
+            joints > std::numeric_limits<std::uint32_t>::max()) {
+            throw std::length_error("Too many chains or joints for a binary chain file");
+        }
+
+        std::string out(HEADER_SIZE + chains.size() * ENTRY_SIZE + joints * JOINT_SIZE, '\0');
+        char *p = out.data();
+        std::memcpy(p, MAGIC, sizeof(MAGIC));
+        Put<std::uint16_t>(p + 4, BINARY_VERSION);
+        Put<std::uint16_t>(p + 6, 0);
+        Put(p + 8, static_cast<std::uint32_t>(chains.size()));
+        Put(p + 12, static_cast<std::uint32_t>(joints));
+
+        char *entry = p + HEADER_SIZE;
+        char *t = entry + chains.size() * ENTRY_SIZE;
+        char *x = t + joints * sizeof(MpInteger);
+        char *y = x + joints * sizeof(MpInteger);
+        char *eX = y + joints * sizeof(MpInteger);
+        char *eY = eX + joints;
+
+        std::size_t first = 0;
+        for (const Chain &chain: chains) {
+            Put(entry, chain.type);
+            Put(entry + 4, chain.width);
+            Put(entry + 8, chain.til);
+            entry[12] = static_cast<char>(chain.es.m_kind);
+            Put(entry + 16, chain.es.m_param);
+            Put(entry + 24, static_cast<std::uint32_t>(first));
+            Put(entry + 28, static_cast<std::uint32_t>(chain.size()));
+            entry += ENTRY_SIZE;
+
+            for (const Joint &joint: chain) {
+                Put(t + first * sizeof(MpInteger), joint.t);
+                Put(x + first * sizeof(MpInteger), joint.x);
+                Put(y + first * sizeof(MpInteger), joint.y);
+                eX[first] = static_cast<char>(joint.eX);
+                eY[first] = static_cast<char>(joint.eY);
+                ++first;
+            }
+        }
+        return out;
+    }
+
+    std::vector<Chain> ParseBinary(const std::string_view bytes) {
+        if (bytes.size() < HEADER_SIZE || std::memcmp(bytes.data(), MAGIC, sizeof(MAGIC)) != 0) {
+            Invalid("missing header");
+        }
+
+        const char *p = bytes.data();
+        if (const auto version = Get<std::uint16_t>(p + 4); version != BINARY_VERSION) {
+            Invalid(std::format("version {} is not supported", version));
+        }
+        const std::size_t count = Get<std::uint32_t>(p + 8);
+        const std::size_t joints = Get<std::uint32_t>(p + 12);
+        if (bytes.size() != HEADER_SIZE + count * ENTRY_SIZE + joints * JOINT_SIZE) {
+            Invalid(std::format("{} bytes for {} chains and {} joints", bytes.size(), count, joints));
+        }
+
+        const char *entry = p + HEADER_SIZE;
+        const char *t = entry + count * ENTRY_SIZE;
+        const char *x = t + joints * sizeof(MpInteger);
+        const char *y = x + joints * sizeof(MpInteger);
+        const char *eX = y + joints * sizeof(MpInteger);
+        const char *eY = eX + joints;
+
+        std::vector<Chain> chains(count);
+        std::size_t next = 0;
+        for (std::size_t c = 0; c < count; ++c, entry += ENTRY_SIZE) {
+            Chain &chain = chains[c];
+            chain.type = Get<MpInteger>(entry);
+            chain.width = Get<MpInteger>(entry + 4);
+            chain.til = Get<MpInteger>(entry + 8);
+            if (!IsKind(entry[12])) {
+                Invalid(std::format("chain {} has an unknown easing kind", c));
+            }
+            chain.es = {static_cast<EasingKind>(entry[12]), Get<double>(entry + 16)};
+
+            const std::size_t first = Get<std::uint32_t>(entry + 24);
+            const std::size_t size = Get<std::uint32_t>(entry + 28);
+            if (first != next || size > joints - first) {
+                Invalid(std::format("chain {} does not own the joints after chain {}", c, c - 1));
+            }
+            next = first + size;
+
+            chain.joints.resize(size);
+            for (std::size_t i = 0; i < size; ++i) {
+                const std::size_t j = first + i;
+                if (!IsMode(eX[j]) || !IsMode(eY[j])) {
+                    Invalid(std::format("joint {} has an unknown easing mode", j));
+                }
+                Joint &joint = chain.joints[i];
+                joint.t = Get<MpInteger>(t + j * sizeof(MpInteger));
+                joint.x = Get<MpInteger>(x + j * sizeof(MpInteger));
+                joint.y = Get<MpInteger>(y + j * sizeof(MpInteger));
+                joint.eX = static_cast<EasingMode>(eX[j]);
+                joint.eY = static_cast<EasingMode>(eY[j]);
+            }
+        }
+        if (next != joints) {
+            Invalid(std::format("{} joints belong to no chain", joints - next));
+        }
+        return chains;
+    }
+
+    std::vector<Chain> LoadBinary(const std::string &filePath) {
+        if (utils::MappedFile mapped; mapped.Open(filePath)) {
+            return ParseBinary(mapped.View());
+        }
+
+        std::ifstream file(filePath, std::ios::binary);
+        if (!file.is_open()) {
+            throw std::invalid_argument("Could not open file: " + filePath);
+        }
+
+        const std::string content((std::istreambuf_iterator(file)), (std::istreambuf_iterator<char>()));
+        return ParseBinary(content);
+    }
+} // namespace mgxc::data
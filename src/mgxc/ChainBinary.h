@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Primitive.h"
+
+namespace mgxc::data {
+    /**
+     * @brief Version written to binary chain files. Readers reject other versions.
+     */
+    constexpr std::uint16_t BINARY_VERSION = 1;
+
+    /**
+     * @brief Serializes chains to the binary chain format (.mgxb).
+     *
+     * All values are little-endian. The layout is:
+     * - Header, 16 bytes: magic "MGXB", version (u16), flags (u16, zero), chain count (u32), joint count (u32).
+     * - Chain table, 32 bytes per chain: type, width, TIL (i32 each), easing kind (char, then 3 bytes of padding),
+     *   easing parameter (f64), index of the chain's first joint and number of joints (u32 each). Chains own
+     *   consecutive runs of joints, in order.
+     * - Joint arrays, one per field over every joint: t, x, y (i32 each), then eX, eY (char each).
+     *
+     * Every array is aligned to its element size, so a mapped file can be read in place. Chains and joints are kept
+     * exactly, in order, so converting to text and back loses nothing for the sorted, non-empty chains Parse yields.
+     *
+     * @param chains The chains.
+     * @return The file contents.
+     * @throws std::length_error if there are more than 2^32 - 1 chains or joints.
+     */
+    std::string SerializeBinary(const std::vector<Chain> &chains);
+
+    /**
+     * @brief Reads chains from the binary chain format, copying the joint arrays into chains without parsing them.
+     * @param bytes Contents of the file.
+     * @return The chains, in file order.
+     * @throws std::invalid_argument if the contents are truncated, of another version, or inconsistent.
+     */
+    std::vector<Chain> ParseBinary(std::string_view bytes);
+
+    /**
+     * @brief Reads a binary chain file, through a read-only mapping where the platform supports it.
+     * @param filePath Path to the file.
+     * @return The chains, in file order.
+     * @throws std::invalid_argument if the file cannot be opened or is not a valid chain file.
+     */
+    std::vector<Chain> LoadBinary(const std::string &filePath);
+} // namespace mgxc::data
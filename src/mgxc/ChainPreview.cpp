@@ -0,0 +1,84 @@
+#include "ChainPreview.h"
+
+namespace mgxc {
+    namespace {
+        bool SameJoint(const Joint &a, const Joint &b) noexcept {
+            return a == b && a.eX == b.eX && a.eY == b.eY;
+        }
+    } // namespace
+
+    bool ChainPreview::Update(const Chain &chain, const std::chrono::steady_clock::duration budget) {
+        const auto deadline = std::chrono::steady_clock::now() + budget;
+        m_recomputed = 0;
+
+        const std::size_t segments = chain.size() < 2 ? 0 : chain.size() - 1;
+        const bool easingChanged = chain.es.m_kind != m_easing.m_kind || chain.es.m_param != m_easing.m_param;
+        if (chain.size() != m_joints.size() || easingChanged) {
+            m_joints.assign(chain.begin(), chain.end());
+            m_easing = chain.es;
+            m_points.resize(segments * (SAMPLES + 1));
+            m_dirty.assign(segments, 1);
+            m_dirtyCount = segments;
+            m_cursor = 0;
+        } else {
+            for (std::size_t i = 0; i < m_joints.size(); ++i) {
+                if (SameJoint(m_joints[i], chain[i])) {
+                    continue;
+                }
+                m_joints[i] = chain[i];
+                if (i > 0) {
+                    MarkDirty(i - 1);
+                }
+                if (i < segments) {
+                    MarkDirty(i);
+                }
+            }
+        }
+
+        // Check the clock every few segments; a segment alone takes well under a microsecond.
+        constexpr std::size_t CHECK_EVERY = 64;
+        for (std::size_t n = 0; m_dirtyCount > 0 && n < segments; ++n) {
+            const std::size_t i = m_cursor;
+            m_cursor = m_cursor + 1 < segments ? m_cursor + 1 : 0;
+            if (!m_dirty[i]) {
+                continue;
+            }
+
+            Recompute(i);
+            m_dirty[i] = 0;
+            --m_dirtyCount;
+            if (++m_recomputed % CHECK_EVERY == 0 && std::chrono::steady_clock::now() >= deadline) {
+                break;
+            }
+        }
+        return m_dirtyCount == 0;
+    }
+
+    void ChainPreview::Reset() noexcept {
+        m_joints.clear();
+        m_points.clear();
+        m_dirty.clear();
+        m_dirtyCount = 0;
+        m_cursor = 0;
+    }
+
+    void ChainPreview::MarkDirty(const std::size_t i) noexcept {
+        if (!m_dirty[i]) {
+            m_dirty[i] = 1;
+            ++m_dirtyCount;
+        }
+    }
+
+    void ChainPreview::Recompute(const std::size_t i) {
+        const Joint &curr = m_joints[i];
+        const Joint &next = m_joints[i + 1];
+        Point *out = m_points.data() + i * (SAMPLES + 1);
+
+        for (std::size_t s = 0; s <= SAMPLES; ++s) {
+            const double u = static_cast<double>(s) / SAMPLES;
+            const double fx = curr.eX == EasingMode::Linear ? u : m_easing.Solve(u, curr.eX);
+            const double fy = curr.eY == EasingMode::Linear ? u : m_easing.Solve(u, curr.eY);
+            out[s] = {curr.t + (next.t - curr.t) * u, curr.x + (next.x - curr.x) * fx, curr.y + (next.y - curr.y) * fy};
+        }
+    }
+} // namespace mgxc
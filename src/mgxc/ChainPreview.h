@@ -0,0 +1,99 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "Easing.h"
+#include "Primitive.h"
+
+namespace mgxc {
+    /**
+     * @class ChainPreview
+     * @brief Sampled curve of a chain for drawing, recomputed only where the chain changed.
+     *
+     * Each segment between two joints is sampled at SAMPLES + 1 evenly spaced points of its easing. Update compares
+     * the chain with the joints it last saw and marks only the segments next to a changed joint dirty; changing the
+     * easing or the number of joints marks every segment. Recomputation stops when the time budget runs out and
+     * resumes on the next Update, so very long chains are refreshed over several frames instead of stalling one.
+     */
+    class ChainPreview {
+    public:
+        /** Number of sample intervals per segment. */
+        static constexpr std::size_t SAMPLES = 16;
+
+        /**
+         * @struct Point
+         * @brief A sample of the curve, before snapping and clamping.
+         */
+        struct Point {
+            double t; /**< Tick. */
+            double x; /**< X position. */
+            double y; /**< Height. */
+        };
+
+        /**
+         * @brief Brings the samples up to date with a chain, within a time budget.
+         * @param chain The chain to preview.
+         * @param budget Time to spend recomputing segments.
+         * @return True if every segment is up to date.
+         */
+        bool Update(const Chain &chain, std::chrono::steady_clock::duration budget);
+        /**
+         * @brief Forgets the chain, so the next Update recomputes every segment.
+         */
+        void Reset() noexcept;
+
+        /**
+         * @brief Gets the number of segments.
+         * @return One less than the number of joints, or 0.
+         */
+        std::size_t GetSegmentCount() const noexcept { return m_dirty.size(); }
+        /**
+         * @brief Gets the samples of a segment.
+         * @param i Index of the segment.
+         * @return SAMPLES + 1 points from its first joint to its second. Stale if the segment is dirty.
+         */
+        std::span<const Point> GetSegment(std::size_t i) const noexcept {
+            return std::span(m_points).subspan(i * (SAMPLES + 1), SAMPLES + 1);
+        }
+        /**
+         * @brief Checks if a segment still waits for recomputation.
+         * @param i Index of the segment.
+         * @return True if its samples are stale.
+         */
+        bool IsDirty(std::size_t i) const noexcept { return m_dirty[i] != 0; }
+        /**
+         * @brief Gets the number of segments waiting for recomputation.
+         * @return Dirty segment count.
+         */
+        std::size_t GetDirtyCount() const noexcept { return m_dirtyCount; }
+        /**
+         * @brief Gets the number of segments the last Update recomputed.
+         * @return Recomputed segment count.
+         */
+        std::size_t GetRecomputed() const noexcept { return m_recomputed; }
+
+    private:
+        std::vector<Joint> m_joints; /**< Joints the samples were computed from. */
+        Easing m_easing{}; /**< Easing the samples were computed with. */
+        std::vector<Point> m_points; /**< Samples, SAMPLES + 1 per segment. */
+        std::vector<std::uint8_t> m_dirty; /**< Nonzero for segments waiting for recomputation. */
+        std::size_t m_dirtyCount{0}; /**< Number of dirty segments. */
+        std::size_t m_cursor{0}; /**< Segment where the next recomputation pass starts. */
+        std::size_t m_recomputed{0}; /**< Segments recomputed by the last Update. */
+
+        /**
+         * @brief Marks a segment dirty.
+         * @param i Index of the segment.
+         */
+        void MarkDirty(std::size_t i) noexcept;
+        /**
+         * @brief Samples a segment.
+         * @param i Index of the segment.
+         */
+        void Recompute(std::size_t i);
+    };
+} // namespace mgxc
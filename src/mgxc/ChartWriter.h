@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+#include "NoteInfo.h"
+
+namespace mgxc {
+    /**
+     * @class ChartWriter
+     * @brief Destination of converted note chains.
+     *
+     * Keeps the conversion pipeline independent of where notes go: the plugin writes them to the editor chart,
+     * tools and tests can collect them anywhere. Writes happen between Begin and either Commit or Discard.
+     */
+    class ChartWriter {
+    public:
+        virtual ~ChartWriter() = default;
+
+        /**
+         * @brief Starts a batch of writes that is kept or dropped as a whole.
+         */
+        virtual void Begin() = 0;
+        /**
+         * @brief Announces how much the writes after Begin will add, so storage can be reserved up front.
+         * @param chains Number of note chains.
+         * @param notes Number of notes in those chains.
+         */
+        virtual void Reserve([[maybe_unused]] std::size_t chains, [[maybe_unused]] std::size_t notes) {}
+        /**
+         * @brief Writes a note chain.
+         * @param noteChain Notes of the chain, starting with its head.
+         */
+        virtual void Write(std::span<const MP_NOTEINFO> noteChain) = 0;
+        /**
+         * @brief Keeps the writes made since Begin.
+         */
+        virtual void Commit() = 0;
+        /**
+         * @brief Drops the writes made since Begin, if the destination supports it.
+         */
+        virtual void Discard() = 0;
+    };
+} // namespace mgxc
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "ChartWriter.h"
+#include "Log.h"
+#include "NoteForest.h"
+#include "NoteInfo.h"
+
+namespace mgxc {
+    /**
+     * @struct CommitStats
+     * @brief Size and interface call count of the last commit.
+     */
+    struct CommitStats {
+        std::size_t chains{0}; /**< Number of note chains written. */
+        std::size_t notes{0}; /**< Number of notes created, including the tap and air notes of air slides. */
+        std::size_t calls{0}; /**< Number of createNote, setInfo, appendChild and appendNote calls. */
+    };
+
+    /**
+     * @class ComChartWriter
+     * @brief Writes note chains as note trees through the Margrete plugin interfaces, as a single undo step.
+     *
+     * Writes only lay the trees out in a NoteForest; Commit replays the whole forest into the chart in one pass, so
+     * the interface calls run back to back with no allocation and no smart pointer copies in between. The handle
+     * supplies the chart and the undo recording and names the interface types, so the same calls reach the editor
+     * through MargreteHandle and an in-process stand-in through mock::Margrete.
+     *
+     * @tparam Handle Provides GetChart, BeginRecording, CommitRecording and DiscardRecording, the Note interface type
+     * and the ComPtr smart pointer template.
+     */
+    template<class Handle>
+    class ComChartWriter final : public ChartWriter {
+    public:
+        /**
+         * @brief Constructs a ComChartWriter.
+         * @param mg Handle for chart access. Must outlive the writer.
+         */
+        explicit ComChartWriter(const Handle &mg) : m_mg(mg) {}
+
+        void Begin() override {
+            m_forest.Clear();
+            m_mg.BeginRecording();
+            m_chart = m_mg.GetChart();
+        }
+
+        void Reserve(const std::size_t chains, const std::size_t notes) override { m_forest.Reserve(chains, notes); }
+
+        void Write(const std::span<const MP_NOTEINFO> noteChain) override {
+            if (!m_chart) {
+                throw std::runtime_error("ComChartWriter::Write called outside Begin and Commit");
+            }
+            m_forest.Append(noteChain);
+        }
+
+        void Commit() override {
+            const auto start = std::chrono::steady_clock::now();
+            Replay();
+            m_chart.reset();
+            m_mg.CommitRecording();
+            m_forest.Clear();
+
+            if (logging::IsEnabled<logging::Level::Info>()) {
+                logging::Log<logging::Level::Info>(
+                        "Committed {} chains as {} notes in {:.3f} ms; {} chart calls, {:.2f} per note", m_stats.chains,
+                        m_stats.notes,
+                        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(),
+                        m_stats.calls,
+                        m_stats.notes ? static_cast<double>(m_stats.calls) / static_cast<double>(m_stats.notes) : 0.0);
+            }
+        }
+
+        void Discard() override {
+            m_forest.Clear();
+            ReleaseNotes();
+            m_chart.reset();
+            m_mg.DiscardRecording();
+        }
+
+        /**
+         * @brief Gets the size and call count of the last commit.
+         * @return Commit statistics.
+         */
+        const CommitStats &GetStats() const noexcept { return m_stats; }
+
+    private:
+        using ChartPtr = decltype(std::declval<const Handle &>().GetChart());
+        using NotePtr = typename Handle::template ComPtr<typename Handle::Note>;
+
+        const Handle &m_mg; /**< Handle to the chart. */
+        ChartPtr m_chart; /**< Chart written to, acquired by Begin. */
+        NoteForest m_forest; /**< Trees written since Begin. */
+        std::vector<NotePtr> m_notes; /**< Notes of the tree being replayed, reused from tree to tree. */
+        CommitStats m_stats; /**< Statistics of the last commit. */
+
+        /**
+         * @brief Creates every note tree of the forest in the chart.
+         *
+         * Each tree is built bottom-up, in the order per-chain writes used: the chain head is created first and every
+         * other note of the chain is created and linked to it in turn, then the notes above the head are created and
+         * linked innermost first, and only then is the complete tree appended to the chart by its root.
+         */
+        void Replay() {
+            const std::span<const MP_NOTEINFO> notes = m_forest.GetNotes();
+            const std::span<const std::int32_t> parents = m_forest.GetParents();
+            const std::span<const std::size_t> bounds = m_forest.GetBounds();
+            const std::span<const std::size_t> heads = m_forest.GetHeads();
+            if (m_notes.size() < m_forest.GetMaxTreeSize()) {
+                m_notes = std::vector<NotePtr>(m_forest.GetMaxTreeSize());
+            }
+            m_stats = {m_forest.GetTreeCount(), notes.size(), 0};
+
+            for (std::size_t t = 0; t + 1 < bounds.size(); ++t) {
+                const std::size_t first = bounds[t];
+                const std::size_t count = bounds[t + 1] - first;
+
+                const std::size_t head = heads[t];
+
+                CreateNote(head, notes[first + head]);
+                for (std::size_t i = head + 1; i < count; ++i) {
+                    CreateNote(i, notes[first + i]);
+                    m_notes[head]->appendChild(m_notes[i].get());
+                }
+                for (std::size_t i = 0; i < head; ++i) {
+                    CreateNote(i, notes[first + i]);
+                }
+                for (std::size_t i = head; i > 0; --i) {
+                    m_notes[parents[first + i]]->appendChild(m_notes[i].get());
+                }
+                m_chart->appendNote(m_notes[0].get());
+                m_stats.calls += count * 3;
+            }
+            ReleaseNotes();
+        }
+
+        /**
+         * @brief Creates a note in the chart and fills it in.
+         * @param index Position of the note in its tree.
+         * @param info Note data.
+         * @throws std::runtime_error If the chart fails to create the note.
+         */
+        void CreateNote(const std::size_t index, const MP_NOTEINFO &info) {
+            if (!m_chart->createNote(m_notes[index].put())) {
+                throw std::runtime_error("Failed to create IMargretePluginNote from IMargretePluginChart");
+            }
+            m_notes[index]->setInfo(&info);
+        }
+
+        /**
+         * @brief Releases the notes held from the last replayed tree.
+         */
+        void ReleaseNotes() noexcept {
+            for (NotePtr &note: m_notes) {
+                note.reset();
+            }
+        }
+    };
+} // namespace mgxc
@@ -0,0 +1,81 @@
+#include "ConversionCache.h"
+
+#include <algorithm>
+#include <bit>
+#include <functional>
+
+namespace {
+    constexpr void HashCombine(std::uint64_t &seed, const std::uint64_t value) noexcept {
+        seed ^= value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+    }
+} // namespace
+
+std::uint64_t ConversionCache::Key(const mgxc::Chain &chain, const Config &cctx) noexcept {
+    std::uint64_t seed = std::hash<std::size_t>{}(chain.size());
+    HashCombine(seed, static_cast<std::uint64_t>(chain.type));
+    HashCombine(seed, static_cast<std::uint64_t>(chain.width));
+    HashCombine(seed, static_cast<std::uint64_t>(chain.til));
+    HashCombine(seed, static_cast<std::uint64_t>(chain.es.m_kind));
+    HashCombine(seed, std::bit_cast<std::uint64_t>(chain.es.m_param));
+
+    for (const mgxc::Joint &joint: chain) {
+        HashCombine(seed, static_cast<std::uint32_t>(joint.t) | static_cast<std::uint64_t>(joint.x) << 32);
+        HashCombine(seed, static_cast<std::uint32_t>(joint.y) | static_cast<std::uint64_t>(joint.eX) << 32 |
+                                  static_cast<std::uint64_t>(joint.eY) << 40);
+    }
+
+    HashCombine(seed, static_cast<std::uint64_t>(cctx.snap));
+    HashCombine(seed, static_cast<std::uint64_t>(cctx.tOffset));
+    HashCombine(seed, static_cast<std::uint64_t>(cctx.xOffset));
+    HashCombine(seed, static_cast<std::uint64_t>(cctx.yOffset));
+    HashCombine(seed, static_cast<std::uint64_t>(cctx.clamp) | static_cast<std::uint64_t>(cctx.easingTables) << 1 |
+                              static_cast<std::uint64_t>(cctx.optimalSampling) << 2);
+    HashCombine(seed, std::bit_cast<std::uint64_t>(cctx.tolerance));
+    return seed;
+}
+
+ConversionCache::Settings::Settings(const Config &cctx) noexcept :
+    snap(cctx.snap), tOffset(cctx.tOffset), xOffset(cctx.xOffset), yOffset(cctx.yOffset), clamp(cctx.clamp),
+    easingTables(cctx.easingTables), optimalSampling(cctx.optimalSampling), tolerance(cctx.tolerance) {}
+
+bool ConversionCache::Matches(const Entry &entry, const mgxc::Chain &chain, const Config &cctx) noexcept {
+    const mgxc::Chain &stored = entry.chain;
+    // Joint's own equality ignores the easing modes, which the output depends on.
+    const auto sameJoint = [](const mgxc::Joint &a, const mgxc::Joint &b) {
+        return a.t == b.t && a.x == b.x && a.y == b.y && a.eX == b.eX && a.eY == b.eY;
+    };
+    return stored.type == chain.type && stored.width == chain.width && stored.til == chain.til &&
+           stored.es.m_kind == chain.es.m_kind && stored.es.m_param == chain.es.m_param &&
+           std::ranges::equal(stored.joints, chain.joints, sameJoint) && entry.settings == Settings(cctx);
+}
+
+const std::vector<MP_NOTEINFO> *ConversionCache::Find(const std::uint64_t key, const mgxc::Chain &chain,
+                                                      const Config &cctx) {
+    const auto it = m_entries.find(key);
+    if (it == m_entries.end() || !Matches(it->second, chain, cctx)) {
+        ++m_misses;
+        return nullptr;
+    }
+
+    ++m_hits;
+    it->second.lastUse = m_conversion;
+    return &it->second.noteChain;
+}
+
+void ConversionCache::Store(const std::uint64_t key, const mgxc::Chain &chain, const Config &cctx,
+                            const std::vector<MP_NOTEINFO> &noteChain) {
+    Entry &entry = m_entries[key];
+    entry.chain = chain;
+    entry.settings = Settings(cctx);
+    entry.noteChain.assign(noteChain.begin(), noteChain.end());
+    entry.lastUse = m_conversion;
+}
+
+void ConversionCache::EndConversion() {
+    if (m_entries.size() > m_capacity) {
+        std::erase_if(m_entries, [this](const auto &entry) { return entry.second.lastUse != m_conversion; });
+    }
+    ++m_conversion;
+}
+
+void ConversionCache::Clear() noexcept { m_entries.clear(); }
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "Config.h"
+#include "NoteInfo.h"
+#include "Primitive.h"
+
+/**
+ * @class ConversionCache
+ * @brief Keeps converted note chains across conversions, so only chains that changed are converted again.
+ *
+ * Entries are keyed by a 64-bit hash of everything the output depends on: the joints, easing, type, width and TIL of
+ * the chain and the snap, offset, clamp, easing table, sampling and tolerance settings. Each entry keeps a copy of
+ * those inputs, and a lookup only hits if they match, so a hash collision converts again rather than reusing another
+ * chain's notes. Not thread-safe; a conversion looks up and stores entries from its calling thread only.
+ */
+class ConversionCache {
+public:
+    /**
+     * @struct Stats
+     * @brief Lookup counters for diagnostics.
+     */
+    struct Stats {
+        std::size_t hits{0}; /**< Lookups that found a converted chain. */
+        std::size_t misses{0}; /**< Lookups that did not. */
+        std::size_t entries{0}; /**< Note chains kept. */
+    };
+
+    /**
+     * @brief Constructs a ConversionCache.
+     * @param capacity Number of note chains above which entries unused by the last conversion are dropped.
+     */
+    explicit ConversionCache(std::size_t capacity = 4096) : m_capacity(capacity) {}
+
+    /**
+     * @brief Computes the key of a chain's conversion.
+     * @param chain The chain.
+     * @param cctx Settings the chain is converted with.
+     * @return The key.
+     */
+    static std::uint64_t Key(const mgxc::Chain &chain, const Config &cctx) noexcept;
+
+    /**
+     * @brief Looks up a converted chain, counting a hit or a miss.
+     * @param key Key of the conversion.
+     * @param chain The chain the key was computed from.
+     * @param cctx Settings the key was computed from.
+     * @return The note chain, or nullptr if absent or stored for other inputs with the same key. Valid until the next
+     * Store, EndConversion or Clear.
+     */
+    const std::vector<MP_NOTEINFO> *Find(std::uint64_t key, const mgxc::Chain &chain, const Config &cctx);
+    /**
+     * @brief Keeps a converted chain, replacing any entry with the same key.
+     * @param key Key of the conversion.
+     * @param chain The chain the key was computed from.
+     * @param cctx Settings the key was computed from.
+     * @param noteChain The note chain.
+     */
+    void Store(std::uint64_t key, const mgxc::Chain &chain, const Config &cctx,
+               const std::vector<MP_NOTEINFO> &noteChain);
+    /**
+     * @brief Marks the end of a conversion, dropping entries it did not use if the cache is over capacity.
+     */
+    void EndConversion();
+    /**
+     * @brief Drops every entry. The counters are kept.
+     */
+    void Clear() noexcept;
+
+    /**
+     * @brief Gets the lookup counters and the number of entries.
+     * @return Cache statistics.
+     */
+    Stats GetStats() const noexcept { return {m_hits, m_misses, m_entries.size()}; }
+    /**
+     * @brief Resets the lookup counters.
+     */
+    void ResetStats() noexcept { m_hits = m_misses = 0; }
+
+private:
+    /**
+     * @struct Settings
+     * @brief The settings of a Config that a conversion depends on.
+     */
+    struct Settings {
+        MpInteger snap{0}; /**< Config::snap. */
+        MpInteger tOffset{0}; /**< Config::tOffset. */
+        MpInteger xOffset{0}; /**< Config::xOffset. */
+        MpInteger yOffset{0}; /**< Config::yOffset. */
+        bool clamp{false}; /**< Config::clamp. */
+        bool easingTables{false}; /**< Config::easingTables. */
+        bool optimalSampling{false}; /**< Config::optimalSampling. */
+        double tolerance{0}; /**< Config::tolerance. */
+
+        Settings() = default;
+        explicit Settings(const Config &cctx) noexcept;
+        bool operator==(const Settings &) const = default;
+    };
+
+    /**
+     * @struct Entry
+     * @brief A converted chain, the inputs it was converted from and the conversion that last used it.
+     */
+    struct Entry {
+        mgxc::Chain chain; /**< The chain converted. */
+        Settings settings; /**< The settings it was converted with. */
+        std::vector<MP_NOTEINFO> noteChain; /**< The note chain. */
+        std::uint64_t lastUse{0}; /**< Conversion that last looked it up or stored it. */
+    };
+
+    /**
+     * @brief Checks if an entry was converted from a chain and settings.
+     * @param entry The entry.
+     * @param chain The chain.
+     * @param cctx The settings.
+     * @return True if every input the key covers is equal.
+     */
+    static bool Matches(const Entry &entry, const mgxc::Chain &chain, const Config &cctx) noexcept;
+
+    std::unordered_map<std::uint64_t, Entry> m_entries; /**< Converted chains by key. */
+    std::size_t m_capacity; /**< Entries kept before pruning. */
+    std::uint64_t m_conversion{0}; /**< Number of the current conversion. */
+    std::size_t m_hits{0}; /**< Lookups that found a converted chain. */
+    std::size_t m_misses{0}; /**< Lookups that did not. */
+};
@@ -0,0 +1,72 @@
+#include "ConversionJob.h"
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+ConversionJob::ConversionJob(const Config &cctx, const int idx, const std::stop_token st, ConversionCache *cache) :
+    ConversionJob(std::make_unique<ConversionSession>(cache), nullptr, cctx, idx, st) {}
+
+ConversionJob::ConversionJob(ConversionSession &session, const Config &cctx, const int idx, const std::stop_token st) :
+    ConversionJob(nullptr, &session, cctx, idx, st) {}
+
+ConversionJob::ConversionJob(std::unique_ptr<ConversionSession> owned, ConversionSession *session, const Config &cctx,
+                             const int idx, const std::stop_token st) :
+    m_owned(std::move(owned)), m_session(m_owned ? m_owned.get() : session), m_idx(idx) {
+    m_session->Begin(cctx);
+    const std::size_t chains = m_session->GetConfig().chains.size();
+    m_total = idx < 0 ? chains : static_cast<std::size_t>(idx) < chains ? 1 : 0;
+
+    if (st.stop_possible()) {
+        m_link.emplace(st, RequestStop{m_stop});
+    }
+    m_thread = std::jthread([this] { Run(); });
+}
+
+ConversionJob::~ConversionJob() { m_stop.request_stop(); }
+
+void ConversionJob::Cancel() noexcept { m_stop.request_stop(); }
+
+void ConversionJob::Wait() const { m_state.wait(State::Running, std::memory_order_acquire); }
+
+float ConversionJob::GetProgress() const noexcept {
+    if (m_total == 0) {
+        return IsFinished() ? 1.0f : 0.0f;
+    }
+    return static_cast<float>(std::min(GetDone(), m_total)) / static_cast<float>(m_total);
+}
+
+bool ConversionJob::Commit(mgxc::ChartWriter &writer) const {
+    if (!IsFinished()) {
+        throw std::logic_error("ConversionJob::Commit called while the job is running");
+    }
+    Rethrow();
+    if (GetState() == State::Cancelled) {
+        return false;
+    }
+
+    m_session->GetInterpolator().Commit(writer);
+    return true;
+}
+
+void ConversionJob::Rethrow() const {
+    if (GetState() == State::Failed) {
+        std::rethrow_exception(m_error);
+    }
+}
+
+void ConversionJob::Run() {
+    State state = State::Done;
+    try {
+        if (!m_session->GetInterpolator().Convert(m_idx, m_stop.get_token(), &m_done)) {
+            state = State::Cancelled;
+        }
+    } catch (...) {
+        m_error = std::current_exception();
+        state = State::Failed;
+    }
+
+    m_state.store(state, std::memory_order_release);
+    m_state.notify_all();
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <stop_token>
+#include <thread>
+
+#include "ChartWriter.h"
+#include "Config.h"
+#include "ConversionCache.h"
+#include "ConversionSession.h"
+#include "Interpolator.h"
+
+/**
+ * @class ConversionJob
+ * @brief Converts chains on a background thread, leaving only the commit to the caller.
+ *
+ * The job works on its own copy of the configuration, so the chains can be edited while it runs. Progress and
+ * state can be polled from any thread; Commit must be called by the thread that owns the chart once the job is done.
+ * Jobs started on a ConversionSession reuse the storage of the session's earlier conversions.
+ */
+class ConversionJob {
+public:
+    /**
+     * @enum State
+     * @brief Stage of a job.
+     */
+    enum class State {
+        Running, /**< Still converting. */
+        Done, /**< Converted every chain; ready to commit. */
+        Cancelled, /**< Stopped before converting every chain. */
+        Failed, /**< A chain could not be converted. */
+    };
+
+    ConversionJob(const ConversionJob &) = delete;
+    ConversionJob &operator=(const ConversionJob &) = delete;
+    /**
+     * @brief Starts converting.
+     * @param cctx Configuration to convert, copied into the job.
+     * @param idx Index of the chain to convert, or -1 for all.
+     * @param st Additional stop token that cancels the job, such as the plugin's.
+     * @param cache If not null, cache of earlier conversions the job reads and extends. Must outlive the job and not
+     * be used elsewhere until the job is finished.
+     */
+    explicit ConversionJob(const Config &cctx, int idx = -1, std::stop_token st = {},
+                           ConversionCache *cache = nullptr);
+    /**
+     * @brief Starts converting on a long-lived session.
+     * @param session Session the configuration is copied into and converted by. Must outlive the job and not be used
+     * elsewhere until the job is finished.
+     * @param cctx Configuration to convert.
+     * @param idx Index of the chain to convert, or -1 for all.
+     * @param st Additional stop token that cancels the job, such as the plugin's.
+     */
+    explicit ConversionJob(ConversionSession &session, const Config &cctx, int idx = -1, std::stop_token st = {});
+    /**
+     * @brief Cancels the job if it is still running and waits for its thread.
+     */
+    ~ConversionJob();
+
+    /**
+     * @brief Requests the job to stop. It stops within one chain per conversion worker.
+     */
+    void Cancel() noexcept;
+    /**
+     * @brief Blocks until the job is no longer running.
+     */
+    void Wait() const;
+
+    /**
+     * @brief Gets the stage of the job.
+     * @return The state.
+     */
+    State GetState() const noexcept { return m_state.load(std::memory_order_acquire); }
+    /**
+     * @brief Checks if the job has stopped running, whatever the outcome.
+     * @return True once the job is done, cancelled or failed.
+     */
+    bool IsFinished() const noexcept { return GetState() != State::Running; }
+    /**
+     * @brief Gets the number of chains converted so far.
+     * @return Chains done.
+     */
+    std::size_t GetDone() const noexcept { return m_done.load(std::memory_order_relaxed); }
+    /**
+     * @brief Gets the number of chains the job converts.
+     * @return Chains in total.
+     */
+    std::size_t GetTotal() const noexcept { return m_total; }
+    /**
+     * @brief Gets the fraction of chains converted so far.
+     * @return Progress in [0, 1].
+     */
+    float GetProgress() const noexcept;
+    /**
+     * @brief Gets the converted note chains.
+     * @return The interpolator holding the output; empty unless the job is done.
+     */
+    const Interpolator &GetInterpolator() const noexcept { return m_session->GetInterpolator(); }
+
+    /**
+     * @brief Commits the converted note chains. Must only be called once the job is finished.
+     * @param writer Destination of the note chains.
+     * @return True if the job was done and its notes were committed, false if it was cancelled.
+     * @throws std::logic_error if the job is still running.
+     * @throws The conversion error if the job failed, or the writer's error if the commit failed.
+     */
+    bool Commit(mgxc::ChartWriter &writer) const;
+    /**
+     * @brief Rethrows the conversion error if the job failed, and does nothing otherwise.
+     */
+    void Rethrow() const;
+
+private:
+    /**
+     * @struct RequestStop
+     * @brief Stop callback forwarding a stop request to the job.
+     */
+    struct RequestStop {
+        std::stop_source source; /**< Stop source of the job. */
+        void operator()() const noexcept { source.request_stop(); }
+    };
+
+    std::unique_ptr<ConversionSession> m_owned; /**< Session of a job started without one. */
+    ConversionSession *m_session; /**< Session converting the configuration. */
+    int m_idx; /**< Index of the chain to convert, or -1 for all. */
+    std::size_t m_total{0}; /**< Number of chains to convert. */
+    std::atomic_size_t m_done{0}; /**< Number of chains converted. */
+    std::atomic<State> m_state{State::Running}; /**< Stage of the job. */
+    std::exception_ptr m_error; /**< Error of a failed job, published by m_state. */
+    std::stop_source m_stop; /**< Stops the conversion. */
+    std::optional<std::stop_callback<RequestStop>> m_link; /**< Forwards the external stop token to m_stop. */
+    std::jthread m_thread; /**< Worker running the conversion; last, so it is joined before the rest is destroyed. */
+
+    /**
+     * @brief Copies the configuration into a session and starts converting it.
+     * @param owned Session owned by the job, or nullptr.
+     * @param session Session to use if the job owns none.
+     * @param cctx Configuration to convert.
+     * @param idx Index of the chain to convert, or -1 for all.
+     * @param st Additional stop token that cancels the job.
+     */
+    ConversionJob(std::unique_ptr<ConversionSession> owned, ConversionSession *session, const Config &cctx, int idx,
+                  std::stop_token st);
+
+    /**
+     * @brief Runs the conversion on the worker thread.
+     */
+    void Run();
+};
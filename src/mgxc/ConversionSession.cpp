@@ -0,0 +1,9 @@
+#include "ConversionSession.h"
+
+ConversionSession::ConversionSession(ConversionCache *cache) : m_interpolator(m_cctx, cache) {}
+
+Interpolator &ConversionSession::Begin(const Config &cctx) {
+    // Copy assignment reuses the storage of the chains and joints already in the snapshot.
+    m_cctx = cctx;
+    return m_interpolator;
+}
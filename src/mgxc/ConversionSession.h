@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Config.h"
+#include "ConversionCache.h"
+#include "Interpolator.h"
+
+/**
+ * @class ConversionSession
+ * @brief A snapshot of the configuration and an interpolator converting it, kept across conversions.
+ *
+ * Each conversion copies the configuration into the snapshot and converts it with the same interpolator, so the
+ * chains, scratch buffers and note chains of the last conversion lend their storage to the next one. Converting a
+ * chart of the same shape again allocates nothing.
+ */
+class ConversionSession {
+public:
+    ConversionSession(const ConversionSession &) = delete;
+    ConversionSession &operator=(const ConversionSession &) = delete;
+    /**
+     * @brief Constructs a ConversionSession.
+     * @param cache If not null, cache of earlier conversions the interpolator reads and extends. Must outlive the
+     * session.
+     */
+    explicit ConversionSession(ConversionCache *cache = nullptr);
+
+    /**
+     * @brief Takes a new snapshot of the configuration to convert.
+     * @param cctx Configuration to convert.
+     * @return The interpolator, ready to convert the snapshot.
+     */
+    Interpolator &Begin(const Config &cctx);
+
+    /**
+     * @brief Gets the snapshot of the configuration.
+     * @return The configuration last passed to Begin.
+     */
+    const Config &GetConfig() const noexcept { return m_cctx; }
+    /**
+     * @brief Gets the interpolator and its output.
+     * @return The interpolator.
+     */
+    Interpolator &GetInterpolator() noexcept { return m_interpolator; }
+    /**
+     * @brief Gets the interpolator and its output.
+     * @return The interpolator.
+     */
+    const Interpolator &GetInterpolator() const noexcept { return m_interpolator; }
+
+private:
+    Config m_cctx; /**< Configuration being converted. */
+    Interpolator m_interpolator; /**< Converter and its output; refers to m_cctx. */
+};
@@ -0,0 +1,38 @@
+// Compiled with AVX2 enabled and only called after a runtime CPU check, so this file must not instantiate any
+// standard library code that could be shared with other translation units.
+
+#include "EasingKernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+
+namespace kernels {
+    namespace {
+        struct Avx2 {
+            using Reg = __m256d;
+            static constexpr std::size_t WIDTH = 4;
+
+            static Reg Set(const double v) { return _mm256_set1_pd(v); }
+            static Reg Load(const double *p) { return _mm256_loadu_pd(p); }
+            static void Store(double *p, const Reg v) { _mm256_storeu_pd(p, v); }
+            static Reg Add(const Reg a, const Reg b) { return _mm256_add_pd(a, b); }
+            static Reg Sub(const Reg a, const Reg b) { return _mm256_sub_pd(a, b); }
+            static Reg Mul(const Reg a, const Reg b) { return _mm256_mul_pd(a, b); }
+            static Reg Div(const Reg a, const Reg b) { return _mm256_div_pd(a, b); }
+            static Reg Sqrt(const Reg a) { return _mm256_sqrt_pd(a); }
+            static Reg Max(const Reg a, const Reg b) { return _mm256_max_pd(a, b); }
+            static Reg Min(const Reg a, const Reg b) { return _mm256_min_pd(a, b); }
+        };
+    } // namespace
+
+    std::size_t CircularOutAvx2(const double *t, double *out, const std::size_t n, const double param,
+                                const bool in) {
+        return CircularOut<Avx2>(t, out, n, param, in);
+    }
+
+    std::size_t InverseCircularOutAvx2(const double *y, double *out, const std::size_t n, const double param,
+                                       const bool in) {
+        return InverseCircularOut<Avx2>(y, out, n, param, in);
+    }
+} // namespace kernels
+#endif
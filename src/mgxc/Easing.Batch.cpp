@@ -0,0 +1,133 @@
+#include <algorithm>
+#include <format>
+#include <stdexcept>
+
+#include "Easing.h"
+#include "EasingKernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define EASING_X64
+#include <emmintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+namespace {
+#ifdef EASING_X64
+    struct Sse2 {
+        using Reg = __m128d;
+        static constexpr std::size_t WIDTH = 2;
+
+        static Reg Set(const double v) { return _mm_set1_pd(v); }
+        static Reg Load(const double *p) { return _mm_loadu_pd(p); }
+        static void Store(double *p, const Reg v) { _mm_storeu_pd(p, v); }
+        static Reg Add(const Reg a, const Reg b) { return _mm_add_pd(a, b); }
+        static Reg Sub(const Reg a, const Reg b) { return _mm_sub_pd(a, b); }
+        static Reg Mul(const Reg a, const Reg b) { return _mm_mul_pd(a, b); }
+        static Reg Div(const Reg a, const Reg b) { return _mm_div_pd(a, b); }
+        static Reg Sqrt(const Reg a) { return _mm_sqrt_pd(a); }
+        static Reg Max(const Reg a, const Reg b) { return _mm_max_pd(a, b); }
+        static Reg Min(const Reg a, const Reg b) { return _mm_min_pd(a, b); }
+    };
+
+    /**
+     * @brief Checks if the CPU and the operating system support AVX2.
+     * @return True if AVX2 kernels can run.
+     */
+    bool HasAvx2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+        int regs[4];
+        __cpuid(regs, 1);
+        const bool osxsave = (regs[2] & (1 << 27)) != 0;
+        const bool avx = (regs[2] & (1 << 28)) != 0;
+        if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+            return false;
+        }
+        __cpuidex(regs, 7, 0);
+        return (regs[1] & (1 << 5)) != 0;
+#else
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+#endif
+
+    using Kernel = std::size_t (*)(const double *, double *, std::size_t, double, bool);
+
+    /**
+     * @struct Kernels
+     * @brief The batch kernels selected for this CPU.
+     */
+    struct Kernels {
+        std::string_view name{"Scalar"};
+        Kernel circularOut{nullptr};
+        Kernel inverseCircularOut{nullptr};
+    };
+
+    const Kernels &GetKernels() {
+        static const Kernels kernels = [] {
+#ifdef EASING_X64
+            if (HasAvx2()) {
+                return Kernels{"AVX2", kernels::CircularOutAvx2, kernels::InverseCircularOutAvx2};
+            }
+            return Kernels{"SSE2", kernels::CircularOut<Sse2>, kernels::InverseCircularOut<Sse2>};
+#else
+            return Kernels{};
+#endif
+        }();
+        return kernels;
+    }
+} // namespace
+
+std::string_view Easing::GetBatchKernel() noexcept { return GetKernels().name; }
+
+void Easing::CheckBatch(const std::span<const double> in, const std::span<double> out) {
+    if (out.size() < in.size()) {
+        throw std::invalid_argument("Output span is shorter than input span");
+    }
+
+    const auto bad = std::ranges::find_if(in, [](const double v) { return v < 0.0 || v > 1.0; });
+    if (bad != in.end()) {
+        throw std::out_of_range(std::format("Value must be in the range [0.0, 1.0], got {}", *bad));
+    }
+}
+
+void Easing::Solve(const std::span<const double> u, const std::span<double> out, const EasingMode mode) const {
+    CheckBatch(u, out);
+
+    if (mode == Linear) {
+        if (out.data() != u.data()) {
+            std::ranges::copy(u, out.begin());
+        }
+        return;
+    }
+
+    std::size_t done = 0;
+    if (m_kind == Circular && GetKernels().circularOut) {
+        done = GetKernels().circularOut(u.data(), out.data(), u.size(), m_param, mode == In);
+    }
+
+    for (std::size_t i = done; i < u.size(); ++i) {
+        out[i] = mode == In ? SolveIn(u[i]) : SolveOut(u[i]);
+    }
+}
+
+void Easing::InverseSolve(const std::span<const double> v, const std::span<double> out, const EasingMode mode) const {
+    CheckBatch(v, out);
+
+    if (mode == Linear) {
+        if (out.data() != v.data()) {
+            std::ranges::copy(v, out.begin());
+        }
+        return;
+    }
+
+    std::size_t done = 0;
+    if (m_kind == Circular && GetKernels().inverseCircularOut) {
+        done = GetKernels().inverseCircularOut(v.data(), out.data(), v.size(), m_param, mode == In);
+    }
+
+    for (std::size_t i = done; i < v.size(); ++i) {
+        out[i] = mode == In ? SolveInverseIn(v[i]) : SolveInverseOut(v[i]);
+    }
+}
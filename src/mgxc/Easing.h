@@ -1,5 +1,6 @@
 #pragma once
 
+#include <span>
 #include <string_view>
 
 /**
@@ -84,6 +85,42 @@ public:
      */
     double InverseSolve(double v, EasingMode mode) const;
 
+    /** Largest difference, in units in the last place, between a batch result and the per-value result. */
+    static constexpr int BATCH_MAX_ULPS = 1;
+
+    /**
+     * @brief Solves the easing function for a batch of inputs.
+     *
+     * Linear and Circular curves are evaluated with SIMD kernels (AVX2 where the CPU supports it, SSE2
+     * otherwise), which perform the same IEEE operations as the per-value path and stay within BATCH_MAX_ULPS
+     * of it. Sine and Power curves are evaluated value by value.
+     *
+     * @param u Input values in [0, 1], checked once for the whole batch.
+     * @param out Receives the eased values. Must be as long as u and may alias it.
+     * @param mode Easing mode (Linear, In, Out).
+     */
+    void Solve(std::span<const double> u, std::span<double> out, EasingMode mode) const;
+    /**
+     * @brief Inversely solves the easing function for a batch of outputs, as the batch Solve does.
+     * @param v Output values in [0, 1], checked once for the whole batch.
+     * @param out Receives the input values that produce them. Must be as long as v and may alias it.
+     * @param mode Easing mode (Linear, In, Out).
+     */
+    void InverseSolve(std::span<const double> v, std::span<double> out, EasingMode mode) const;
+    /**
+     * @brief Gets the name of the instruction set the batch kernels run on.
+     * @return "AVX2", "SSE2" or "Scalar".
+     */
+    static std::string_view GetBatchKernel() noexcept;
+    /**
+     * @brief Checks the arguments of a batch entry point once for the whole batch.
+     * @param in Values that must lie in [0, 1].
+     * @param out Output span that must be at least as long as in.
+     * @throws std::out_of_range If a value lies outside [0, 1].
+     * @throws std::invalid_argument If out is shorter than in.
+     */
+    static void CheckBatch(std::span<const double> in, std::span<double> out);
+
     EasingKind m_kind{Sine}; /**< The kind of easing function. */
     double m_param{0}; /**< The parameter for the easing function, if any. */
 
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+ * @brief Vectorized kernels behind the batch entry points of Easing.
+ *
+ * Every kernel takes a register abstraction V providing WIDTH, Reg, Set, Load, Store, Add, Sub, Mul, Div, Sqrt,
+ * Max and Min, and processes whole registers only; it returns the number of values done so the caller finishes
+ * the tail value by value. The operations mirror Easing's scalar code one for one, so both paths round
+ * identically. This header must stay free of standard library code: it is also compiled for AVX2.
+ */
+namespace kernels {
+    /**
+     * @brief Evaluates the Circular Out curve, or its In mirror.
+     * @tparam V Register abstraction.
+     * @param t Input values.
+     * @param out Output values.
+     * @param n Number of values.
+     * @param param Linearity of the curve.
+     * @param in True for the In mirror.
+     * @return Number of values processed.
+     */
+    template<class V>
+    std::size_t CircularOut(const double *t, double *out, const std::size_t n, const double param, const bool in) {
+        using R = typename V::Reg;
+        const R one = V::Set(1.0);
+        const R p = V::Set(param);
+        const R q = V::Set(1.0 - param);
+
+        std::size_t i = 0;
+        for (; i + V::WIDTH <= n; i += V::WIDTH) {
+            R x = V::Load(t + i);
+            if (in) {
+                x = V::Sub(one, x);
+            }
+            R y = V::Add(V::Mul(p, x), V::Mul(q, V::Sub(one, V::Sqrt(V::Sub(one, V::Mul(x, x))))));
+            if (in) {
+                y = V::Sub(one, y);
+            }
+            V::Store(out + i, y);
+        }
+        return i;
+    }
+
+    /**
+     * @brief Evaluates the inverse of the Circular Out curve, or of its In mirror.
+     * @tparam V Register abstraction.
+     * @param y Input values.
+     * @param out Output values.
+     * @param n Number of values.
+     * @param param Linearity of the curve.
+     * @param in True for the In mirror.
+     * @return Number of values processed.
+     */
+    template<class V>
+    std::size_t InverseCircularOut(const double *y, double *out, const std::size_t n, const double param,
+                                   const bool in) {
+        using R = typename V::Reg;
+        const R zero = V::Set(0.0);
+        const R one = V::Set(1.0);
+
+        const double bias = param / (1.0 - param);
+        const double qA = 1.0 + bias * bias;
+        const R rest = V::Set(1.0 - param);
+        const R rBias = V::Set(bias);
+        const R two = V::Set(2.0);
+        const R fourA = V::Set(4.0 * qA);
+        const R twoA = V::Set(2.0 * qA);
+
+        std::size_t i = 0;
+        for (; i + V::WIDTH <= n; i += V::WIDTH) {
+            R v = V::Load(y + i);
+            if (in) {
+                v = V::Sub(one, v);
+            }
+
+            R x;
+            if (param == 1.0) {
+                x = v;
+            } else if (param == 0.0) {
+                const R w = V::Sub(one, v);
+                x = V::Sqrt(V::Sub(one, V::Mul(w, w)));
+            } else {
+                const R offset = V::Div(V::Sub(rest, v), rest);
+                const R qB = V::Mul(V::Mul(two, offset), rBias);
+                const R qC = V::Sub(V::Mul(offset, offset), one);
+                const R disc = V::Max(V::Sub(V::Mul(qB, qB), V::Mul(fourA, qC)), zero);
+                x = V::Min(V::Max(V::Div(V::Sub(V::Sqrt(disc), qB), twoA), zero), one);
+            }
+
+            if (in) {
+                x = V::Sub(one, x);
+            }
+            V::Store(out + i, x);
+        }
+        return i;
+    }
+
+    /** CircularOut for AVX2, defined in a translation unit compiled for AVX2. */
+    std::size_t CircularOutAvx2(const double *t, double *out, std::size_t n, double param, bool in);
+    /** InverseCircularOut for AVX2, defined in a translation unit compiled for AVX2. */
+    std::size_t InverseCircularOutAvx2(const double *y, double *out, std::size_t n, double param, bool in);
+} // namespace kernels
@@ -0,0 +1,246 @@
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <format>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+#include "EasingTable.h"
+
+namespace {
+    constexpr std::uint64_t EXPONENT_MASK = 0x7ff0000000000000;
+    constexpr std::uint64_t MANTISSA_MASK = 0x000fffffffffffff;
+    constexpr std::uint64_t ONE_BITS = 0x3ff0000000000000;
+
+    /**
+     * @brief Gets the input at a position of the sample grid.
+     * @param upper Whether the position is in the upper half.
+     * @param octave Octave of the position.
+     * @param pos Position within the octave, in intervals.
+     * @param n Number of intervals per octave.
+     * @return The input value.
+     */
+    double GridPoint(const bool upper, const int octave, const double pos, const std::size_t n) {
+        const double y = std::ldexp(1.0 + pos / static_cast<double>(n), -(octave + 2));
+        return upper ? 1.0 - y : y;
+    }
+} // namespace
+
+void EasingTable::Curve::Sample(const double *values, double *slopes, const std::size_t n) {
+    std::vector<double> secants(n);
+    for (std::size_t k = 0; k < n; ++k) {
+        secants[k] = values[k + 1] - values[k];
+    }
+
+    slopes[0] = secants[0];
+    slopes[n] = secants[n - 1];
+    for (std::size_t k = 1; k < n; ++k) {
+        // A tangent at a local extremum must be flat, or the spline overshoots it.
+        slopes[k] = secants[k - 1] * secants[k] <= 0.0 ? 0.0 : (secants[k - 1] + secants[k]) / 2.0;
+    }
+
+    // Fritsch-Carlson: limit the tangents of every interval to the monotonicity region.
+    for (std::size_t k = 0; k < n; ++k) {
+        if (secants[k] == 0.0) {
+            slopes[k] = 0.0;
+            slopes[k + 1] = 0.0;
+            continue;
+        }
+
+        const double a = slopes[k] / secants[k];
+        const double b = slopes[k + 1] / secants[k];
+        const double r = a * a + b * b;
+        if (r > 9.0) {
+            const double tau = 3.0 / std::sqrt(r);
+            slopes[k] = tau * a * secants[k];
+            slopes[k + 1] = tau * b * secants[k];
+        }
+    }
+}
+
+bool EasingTable::Curve::Lookup(const double x, double &y) const noexcept {
+    if (x == 0.0) {
+        y = m_first;
+        return true;
+    }
+    if (x == 1.0) {
+        y = m_last;
+        return true;
+    }
+
+    // 1 - x is exact for x >= 0.5, so both halves index their octaves by an exact distance to the end.
+    const bool upper = x > 0.5;
+    const std::uint64_t bits = std::bit_cast<std::uint64_t>(upper ? 1.0 - x : x);
+
+    const int n = static_cast<int>(m_intervals);
+    int octave = 1021 - static_cast<int>((bits & EXPONENT_MASK) >> 52);
+    double pos = (std::bit_cast<double>((bits & MANTISSA_MASK) | ONE_BITS) - 1.0) * n;
+    if (octave < 0) {
+        // Only x = 0.5 itself lies above the first octave; it is the first octave's upper end.
+        octave = 0;
+        pos = n;
+    } else if (octave >= OCTAVES) {
+        return false;
+    }
+
+    const int k = std::min(static_cast<int>(pos), n - 1);
+    const double s = pos - k;
+    const std::size_t i = ((upper ? OCTAVES : 0) + octave) * (n + 1) + k;
+
+    const double s2 = s * s;
+    const double r = 1.0 - s;
+    const double r2 = r * r;
+    y = (1.0 + 2.0 * s) * r2 * m_values[i] + s * r2 * m_slopes[i] + s2 * (3.0 - 2.0 * s) * m_values[i + 1] -
+        s2 * r * m_slopes[i + 1];
+    return true;
+}
+
+template<class F>
+bool EasingTable::Curve::Build(F f, const double tolerance) {
+    m_first = f(0.0);
+    m_last = f(1.0);
+
+    for (std::size_t n = MIN_INTERVALS; n <= MAX_INTERVALS && std::isfinite(m_first) && std::isfinite(m_last);
+         n *= 2) {
+        m_intervals = n;
+        m_values.assign(2 * OCTAVES * (n + 1), 0.0);
+        m_slopes.assign(m_values.size(), 0.0);
+
+        bool finite = true;
+        for (int half = 0; half < 2; ++half) {
+            for (int octave = 0; octave < OCTAVES; ++octave) {
+                const std::size_t base = (half * OCTAVES + octave) * (n + 1);
+                for (std::size_t k = 0; k <= n; ++k) {
+                    m_values[base + k] = f(GridPoint(half == 1, octave, static_cast<double>(k), n));
+                    finite = finite && std::isfinite(m_values[base + k]);
+                }
+                Sample(&m_values[base], &m_slopes[base], n);
+            }
+        }
+        if (!finite) {
+            break;
+        }
+
+        double error = 0.0;
+        for (int half = 0; half < 2 && error <= tolerance; ++half) {
+            for (int octave = 0; octave < OCTAVES && error <= tolerance; ++octave) {
+                for (std::size_t k = 0; k < n; ++k) {
+                    for (const double s: {0.25, 0.5, 0.75}) {
+                        const double x = GridPoint(half == 1, octave, static_cast<double>(k) + s, n);
+                        double y;
+                        Lookup(x, y);
+                        error = std::max(error, std::abs(y - f(x)));
+                    }
+                }
+            }
+        }
+        if (error <= tolerance) {
+            return true;
+        }
+    }
+
+    m_intervals = 0;
+    m_values.clear();
+    m_slopes.clear();
+    return false;
+}
+
+EasingTable::EasingTable(const Easing &easing, const double tolerance) : m_easing(easing) {
+    m_forward.Build([this](const double u) { return m_easing.Solve(u, EasingMode::Out); }, tolerance);
+    m_inverse.Build([this](const double v) { return m_easing.InverseSolve(v, EasingMode::Out); }, tolerance);
+}
+
+std::shared_ptr<const EasingTable> EasingTable::Get(const Easing &easing) {
+    using Key = std::pair<EasingKind, double>;
+    static std::mutex mutex;
+    // Most recently used first; short enough that a linear search beats a map.
+    static std::list<std::pair<Key, std::shared_ptr<const EasingTable>>> cache;
+
+    const Key key{easing.m_kind, easing.m_param};
+    const std::scoped_lock lock(mutex);
+    const auto it = std::ranges::find(cache, key, &decltype(cache)::value_type::first);
+    if (it != cache.end()) {
+        cache.splice(cache.begin(), cache, it);
+    } else {
+        cache.emplace_front(key, std::make_shared<const EasingTable>(easing));
+        if (cache.size() > CACHE_CAPACITY) {
+            cache.pop_back();
+        }
+    }
+    return cache.front().second;
+}
+
+double EasingTable::Solve(const double u, const EasingMode mode) const {
+    if (u < 0.0 || u > 1.0) {
+        throw std::out_of_range(std::format("Value must be in the range [0.0, 1.0], got {}", u));
+    }
+
+    if (mode == EasingMode::Linear) {
+        return u;
+    }
+
+    double v;
+    if (m_forward.Empty() || !m_forward.Lookup(mode == EasingMode::In ? 1.0 - u : u, v)) {
+        return m_easing.Solve(u, mode);
+    }
+    return mode == EasingMode::In ? 1.0 - v : v;
+}
+
+double EasingTable::InverseSolve(const double v, const EasingMode mode) const {
+    if (v < 0.0 || v > 1.0) {
+        throw std::out_of_range(std::format("Value must be in the range [0.0, 1.0], got {}", v));
+    }
+
+    if (mode == EasingMode::Linear) {
+        return v;
+    }
+
+    double u;
+    if (m_inverse.Empty() || !m_inverse.Lookup(mode == EasingMode::In ? 1.0 - v : v, u)) {
+        return m_easing.InverseSolve(v, mode);
+    }
+    return mode == EasingMode::In ? 1.0 - u : u;
+}
+
+void EasingTable::Solve(const std::span<const double> u, const std::span<double> out, const EasingMode mode) const {
+    if (m_forward.Empty()) {
+        m_easing.Solve(u, out, mode);
+        return;
+    }
+
+    Easing::CheckBatch(u, out);
+    for (std::size_t i = 0; i < u.size(); ++i) {
+        double v;
+        if (mode == EasingMode::Linear) {
+            out[i] = u[i];
+        } else if (!m_forward.Lookup(mode == EasingMode::In ? 1.0 - u[i] : u[i], v)) {
+            out[i] = m_easing.Solve(u[i], mode);
+        } else {
+            out[i] = mode == EasingMode::In ? 1.0 - v : v;
+        }
+    }
+}
+
+void EasingTable::InverseSolve(const std::span<const double> v, const std::span<double> out,
+                               const EasingMode mode) const {
+    if (m_inverse.Empty()) {
+        m_easing.InverseSolve(v, out, mode);
+        return;
+    }
+
+    Easing::CheckBatch(v, out);
+    for (std::size_t i = 0; i < v.size(); ++i) {
+        double u;
+        if (mode == EasingMode::Linear) {
+            out[i] = v[i];
+        } else if (!m_inverse.Lookup(mode == EasingMode::In ? 1.0 - v[i] : v[i], u)) {
+            out[i] = m_easing.InverseSolve(v[i], mode);
+        } else {
+            out[i] = mode == EasingMode::In ? 1.0 - u : u;
+        }
+    }
+}
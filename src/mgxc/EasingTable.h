@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "Easing.h"
+
+/**
+ * @class EasingTable
+ * @brief Evaluates an easing function through sampled tables instead of sin/asin/pow/sqrt.
+ *
+ * The Out curve and its inverse are sampled and interpolated with monotone cubic (Fritsch-Carlson) Hermite
+ * splines, so a lookup is a handful of multiplications and the tabulated curves stay monotone wherever the
+ * analytic ones are. In curves mirror the Out tables.
+ *
+ * Samples are spaced uniformly within octaves that halve towards both ends of [0, 1], and the octave is read
+ * straight from the exponent of the input. That keeps the error bounded near the infinite slopes that
+ * inverse, Power and Circular curves have at their ends. Every curve is checked against the analytic function
+ * on a grid four times denser than its samples and refined until it meets the tolerance; a curve that still
+ * misses it at MAX_INTERVALS, and inputs closer than 2^-(OCTAVES + 1) to either end, are evaluated
+ * analytically instead.
+ */
+class EasingTable {
+public:
+    /** Default bound on the absolute error of a tabulated curve. */
+    static constexpr double DEFAULT_TOLERANCE = 1e-7;
+    /** Number of octaves tabulated towards each end of [0, 1]. */
+    static constexpr int OCTAVES = 30;
+    /** Number of intervals per octave a table starts with. */
+    static constexpr std::size_t MIN_INTERVALS = 16;
+    /** Number of intervals per octave beyond which a curve falls back to the analytic function. */
+    static constexpr std::size_t MAX_INTERVALS = 1024;
+    /** Number of most recently used tables Get keeps alive. */
+    static constexpr std::size_t CACHE_CAPACITY = 16;
+
+    /**
+     * @brief Builds the tables of an easing function.
+     * @param easing The easing function.
+     * @param tolerance Bound on the absolute error of a tabulated curve.
+     */
+    explicit EasingTable(const Easing &easing, double tolerance = DEFAULT_TOLERANCE);
+
+    /**
+     * @brief Gets the shared tables of an easing function, building them on first use.
+     *
+     * The CACHE_CAPACITY most recently used tables are cached; older ones are freed once no caller holds them, so
+     * a stream of distinct parameters does not keep every table alive. Tables may be used from any thread.
+     *
+     * @param easing The easing function.
+     * @return Tables built with DEFAULT_TOLERANCE.
+     */
+    static std::shared_ptr<const EasingTable> Get(const Easing &easing);
+
+    /**
+     * @brief Solves the easing function, as Easing::Solve does.
+     * @param u Input value in [0, 1].
+     * @param mode Easing mode (Linear, In, Out).
+     * @return The eased value.
+     */
+    double Solve(double u, EasingMode mode) const;
+    /**
+     * @brief Inversely solves the easing function, as Easing::InverseSolve does.
+     * @param v Output value in [0, 1].
+     * @param mode Easing mode (Linear, In, Out).
+     * @return The input value that produces the given output.
+     */
+    double InverseSolve(double v, EasingMode mode) const;
+    /**
+     * @brief Solves the easing function for a batch of inputs, as Easing's batch Solve does.
+     * @param u Input values in [0, 1], checked once for the whole batch.
+     * @param out Receives the eased values. Must be as long as u and may alias it.
+     * @param mode Easing mode (Linear, In, Out).
+     */
+    void Solve(std::span<const double> u, std::span<double> out, EasingMode mode) const;
+    /**
+     * @brief Inversely solves the easing function for a batch of outputs, as Easing's batch InverseSolve does.
+     * @param v Output values in [0, 1], checked once for the whole batch.
+     * @param out Receives the input values that produce them. Must be as long as v and may alias it.
+     * @param mode Easing mode (Linear, In, Out).
+     */
+    void InverseSolve(std::span<const double> v, std::span<double> out, EasingMode mode) const;
+
+    /**
+     * @brief Checks if Solve is served from a table.
+     * @return True if the forward curve met the tolerance.
+     */
+    bool IsForwardTabulated() const noexcept { return !m_forward.Empty(); }
+    /**
+     * @brief Checks if InverseSolve is served from a table.
+     * @return True if the inverse curve met the tolerance.
+     */
+    bool IsInverseTabulated() const noexcept { return !m_inverse.Empty(); }
+
+private:
+    /**
+     * @class Curve
+     * @brief A monotone cubic Hermite spline over samples of [0, 1] that are uniform within each octave.
+     *
+     * Octave o of the lower half spans [2^-(o+2), 2^-(o+1)]; the upper half mirrors it through 1 - x.
+     */
+    class Curve {
+    public:
+        /**
+         * @brief Samples a function until the spline meets the tolerance.
+         * @tparam F Callable as f(double) -> double on [0, 1].
+         * @param f The function to sample.
+         * @param tolerance Bound on the absolute error.
+         * @return True if the tolerance was met within MAX_INTERVALS; otherwise the curve is left empty.
+         */
+        template<class F>
+        bool Build(F f, double tolerance);
+
+        bool Empty() const noexcept { return m_values.empty(); }
+        /**
+         * @brief Interpolates the curve.
+         * @param x Input value in [0, 1].
+         * @param y Receives the interpolated value.
+         * @return False if x is too close to an end to be covered by the octaves.
+         */
+        bool Lookup(double x, double &y) const noexcept;
+
+    private:
+        std::size_t m_intervals{0}; /**< Number of intervals per octave. */
+        std::vector<double> m_values; /**< Samples of every octave of both halves, ends included. */
+        std::vector<double> m_slopes; /**< Tangents at the samples, scaled by the interval width. */
+        double m_first{0}; /**< Value at 0. */
+        double m_last{0}; /**< Value at 1. */
+
+        static void Sample(const double *values, double *slopes, std::size_t n);
+    };
+
+    Easing m_easing; /**< The analytic function, used where a curve is not tabulated. */
+    Curve m_forward; /**< The Out curve. */
+    Curve m_inverse; /**< The inverse of the Out curve. */
+};
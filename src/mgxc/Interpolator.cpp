@@ -1,25 +1,128 @@
 #define NOMINMAX
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <exception>
 #include <format>
-#include <iostream>
+#include <iterator>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <stop_token>
+#include <string>
 #include <utility>
 #include <vector>
 
 #include "Interpolator.h"
-#include "MargreteHandle.h"
+#include "Log.h"
+#include "Parallel.h"
 #include "Primitive.h"
 #include "Utils.h"
 
-Interpolator::Interpolator(Config &cctx) : m_cctx(cctx) {}
+Interpolator::Interpolator(Config &cctx, ConversionCache *cache) : m_cctx(cctx), m_cache(cache) {}
 
 void Interpolator::ResetOutput() {
+    // Pushed last to first, so PrepareOutput hands each chain the storage it had in the last conversion.
+    for (auto it = m_noteChains.rbegin(); it != m_noteChains.rend(); ++it) {
+        it->clear();
+        m_spare.push_back(std::move(*it));
+    }
     m_noteChains.clear();
-    m_noteChain.clear();
 }
 
-void Interpolator::PushSegment(const mgxc::Chain &chain, const mgxc::Joint &curr, const mgxc::Joint &next,
-                               const mgxc::Joint &base) {
+void Interpolator::PrepareOutput(const std::size_t count) {
+    ResetOutput();
+    while (m_noteChains.size() < count) {
+        if (m_spare.empty()) {
+            m_noteChains.emplace_back();
+        } else {
+            m_noteChains.push_back(std::move(m_spare.back()));
+            m_spare.pop_back();
+        }
+    }
+    // Room to take every note chain back, so the next ResetOutput does not allocate.
+    m_spare.reserve(m_spare.size() + m_noteChains.size());
+}
+
+double Interpolator::Solve(const Scratch &scratch, const mgxc::Chain &chain, const double u, const EasingMode mode) {
+    return scratch.table ? scratch.table->Solve(u, mode) : chain.es.Solve(u, mode);
+}
+
+void Interpolator::Solve(const Scratch &scratch, const mgxc::Chain &chain, const std::span<const double> u,
+                         const std::span<double> out, const EasingMode mode) {
+    if (scratch.table) {
+        scratch.table->Solve(u, out, mode);
+    } else {
+        chain.es.Solve(u, out, mode);
+    }
+}
+
+void Interpolator::InverseSolve(const Scratch &scratch, const mgxc::Chain &chain, const std::span<const double> v,
+                                const std::span<double> out, const EasingMode mode) {
+    if (scratch.table) {
+        scratch.table->InverseSolve(v, out, mode);
+    } else {
+        chain.es.InverseSolve(v, out, mode);
+    }
+}
+
+std::size_t Interpolator::EstimateNotes(const mgxc::Chain &chain, const MpInteger snap) noexcept {
+    if (chain.size() < 2) {
+        return 0;
+    }
+
+    std::size_t notes = 1;
+    mgxc::Joint curr = chain[0].Snap(snap);
+    for (std::size_t i = 1; i < chain.size(); ++i) {
+        const mgxc::Joint next = chain[i].Snap(snap);
+        notes += SegmentNotes(curr, next);
+        curr = next;
+    }
+    return notes;
+}
+
+Interpolator::Estimate Interpolator::EstimateOutput(const Config &cctx, const int idx) noexcept {
+    std::size_t first = 0;
+    std::size_t count = cctx.chains.size();
+    if (idx >= 0) {
+        first = static_cast<std::size_t>(idx);
+        count = first < cctx.chains.size() ? 1 : 0;
+    }
+
+    Estimate estimate{count};
+    for (std::size_t i = first; i < first + count; ++i) {
+        const std::size_t notes = EstimateNotes(cctx.chains[i], cctx.snap);
+        estimate.notes += notes;
+        estimate.largest = std::max(estimate.largest, notes);
+    }
+    return estimate;
+}
+
+std::size_t Interpolator::SegmentNotes(const mgxc::Joint &curr, const mgxc::Joint &next) noexcept {
+    if (next.t <= curr.t) {
+        return 0;
+    }
+
+    // Mirrors the choice in InterpolateChain: linear, stepped along y, or stepped along x.
+    const bool sameX = curr.x == next.x;
+    const bool sameY = curr.y == next.y;
+    std::size_t steps = 1;
+    if ((sameX || curr.eX == EasingMode::Linear) && (sameY || curr.eY == EasingMode::Linear)) {
+        steps = 1;
+    } else if (sameX) {
+        steps = static_cast<std::size_t>(std::abs(next.y - curr.y));
+    } else {
+        steps = static_cast<std::size_t>(std::abs(next.x - curr.x));
+    }
+    return std::min(steps, static_cast<std::size_t>(next.t - curr.t));
+}
+
+void Interpolator::PushSegment(Scratch &scratch, const mgxc::Chain &chain, const mgxc::Joint &curr,
+                               const mgxc::Joint &next, const mgxc::Joint &base) {
+    std::vector<MP_NOTEINFO> &noteChain = scratch.noteChain;
 
     MP_NOTEINFO note{};
     note.type = chain.type;
@@ -34,12 +137,12 @@ void Interpolator::PushSegment(const mgxc::Chain &chain, const mgxc::Joint &curr
     note.timelineId = chain.til;
     note.optionValue = MP_OPTIONVALUE_AIRCRUSH_TRACELIKE;
 
-    if (m_noteChain.empty() || m_noteChain.back().tick != base.t) {
-        m_noteChain.push_back(note);
+    if (noteChain.empty() || noteChain.back().tick != base.t) {
+        noteChain.push_back(note);
         return;
     }
 
-    MP_NOTEINFO &last = m_noteChain.back();
+    MP_NOTEINFO &last = noteChain.back();
     if (last.x == base.x && last.height == base.y && last.tick == base.t) {
         return;
     }
@@ -49,13 +152,13 @@ void Interpolator::PushSegment(const mgxc::Chain &chain, const mgxc::Joint &curr
     const double dY = next.y - curr.y;
 
     const double pT = (base.t - curr.t) / dT;
-    const double fPTx = chain.es.Solve(pT, curr.eX);
+    const double fPTx = Solve(scratch, chain, pT, curr.eX);
     const double idealX = curr.x + fPTx * dX;
     double errLast = std::abs(idealX - last.x);
     double errNew = std::abs(idealX - base.x);
 
     if (dY != 0) {
-        const double fPTy = chain.es.Solve(pT, curr.eY);
+        const double fPTy = Solve(scratch, chain, pT, curr.eY);
         const double idealY = curr.y + fPTy * dY;
         errLast = std::hypot(errLast, std::abs(idealY - last.height));
         errNew = std::hypot(errNew, std::abs(idealY - base.y));
@@ -66,50 +169,293 @@ void Interpolator::PushSegment(const mgxc::Chain &chain, const mgxc::Joint &curr
     }
 }
 
-void Interpolator::VerticalSegment(const mgxc::Chain &chain, const mgxc::Joint &curr, const mgxc::Joint &next) {
+void Interpolator::PushStep(Scratch &scratch, const mgxc::Chain &chain, const mgxc::Joint &curr,
+                            const mgxc::Joint &next, const mgxc::Joint &base) {
+    if (scratch.optimal) {
+        scratch.candidates.push_back(base);
+    } else {
+        PushSegment(scratch, chain, curr, next, base);
+    }
+}
+
+void Interpolator::SampleSegment(Scratch &scratch, const mgxc::Chain &chain, const mgxc::Joint &curr,
+                                 const mgxc::Joint &next) {
+    std::vector<mgxc::Joint> &candidates = scratch.candidates;
+    const auto sameTick = [](const mgxc::Joint &a, const mgxc::Joint &b) { return a.t == b.t; };
+    if (std::ranges::adjacent_find(candidates, sameTick) == candidates.end()) {
+        // One candidate per tick leaves nothing to choose.
+        for (const mgxc::Joint &candidate: candidates) {
+            PushSegment(scratch, chain, curr, next, candidate);
+        }
+        candidates.clear();
+        return;
+    }
+
+    const double dT = next.t - curr.t;
+    const double dX = next.x - curr.x;
+    const double dY = next.y - curr.y;
+    const auto curve = [&](const double tick) {
+        const double u = (tick - curr.t) / dT;
+        return std::pair(curr.x + Solve(scratch, chain, u, curr.eX) * dX,
+                         curr.y + Solve(scratch, chain, u, curr.eY) * dY);
+    };
+
+    // Layers of candidates at the same tick, narrowed in place to the band around the one nearest the curve.
+    std::vector<std::size_t> &layers = scratch.layers;
+    layers.clear();
+    std::size_t kept = 0;
+    for (std::size_t begin = 0; begin < candidates.size();) {
+        std::size_t end = begin + 1;
+        while (end < candidates.size() && candidates[end].t == candidates[begin].t) {
+            ++end;
+        }
+
+        std::size_t lo = begin;
+        std::size_t hi = end;
+        if (begin == 0) {
+            hi = begin + 1;
+        } else if (end == candidates.size()) {
+            lo = end - 1;
+        } else if (end - begin > SAMPLING_BAND) {
+            const auto [x, y] = curve(candidates[begin].t);
+            std::size_t nearest = begin;
+            double least = std::numeric_limits<double>::infinity();
+            for (std::size_t j = begin; j < end; ++j) {
+                if (const double d = std::hypot(candidates[j].x - x, candidates[j].y - y); d < least) {
+                    least = d;
+                    nearest = j;
+                }
+            }
+            lo = std::clamp(nearest - std::min(nearest, SAMPLING_BAND / 2), begin, end - SAMPLING_BAND);
+            hi = lo + SAMPLING_BAND;
+        }
+
+        layers.push_back(kept);
+        for (std::size_t j = lo; j < hi; ++j) {
+            candidates[kept++] = candidates[j];
+        }
+        begin = end;
+    }
+    layers.push_back(kept);
+    candidates.resize(kept);
+
+    std::vector<double> &cost = scratch.cost;
+    std::vector<std::size_t> &from = scratch.from;
+    cost.assign(kept, 0);
+    from.assign(kept, 0);
+    for (std::size_t l = 0; l + 2 < layers.size(); ++l) {
+        const std::size_t a = layers[l];
+        const std::size_t b = layers[l + 1];
+        const std::size_t c = layers[l + 2];
+        if (b - a == 1 && c - b == 1) {
+            // Every path passes through both, so the distance between them does not change which path is least.
+            cost[b] = cost[a];
+            from[b] = a;
+            continue;
+        }
+
+        // The curve at every point after this layer, up to and including the next one, solved in one batch per axis.
+        const int start = candidates[a].t;
+        const int points = (candidates[b].t - start) * scratch.subticks;
+        scratch.params.resize(points);
+        scratch.curveX.resize(points);
+        scratch.curveY.resize(points);
+        for (int i = 0; i < points; ++i) {
+            scratch.params[i] = (start - curr.t + static_cast<double>(i + 1) / scratch.subticks) / dT;
+        }
+        Solve(scratch, chain, scratch.params, scratch.curveX, curr.eX);
+        Solve(scratch, chain, scratch.params, scratch.curveY, curr.eY);
+        for (int i = 0; i < points; ++i) {
+            scratch.curveX[i] = curr.x + scratch.curveX[i] * dX;
+            scratch.curveY[i] = curr.y + scratch.curveY[i] * dY;
+        }
+
+        for (std::size_t q = b; q < c; ++q) {
+            cost[q] = std::numeric_limits<double>::infinity();
+            for (std::size_t p = a; p < b; ++p) {
+                double total = cost[p];
+                for (int i = 0; i < points; ++i) {
+                    const double f = static_cast<double>(i + 1) / points;
+                    const double x = candidates[p].x + f * (candidates[q].x - candidates[p].x);
+                    const double y = candidates[p].y + f * (candidates[q].y - candidates[p].y);
+                    // Distances here are at most a few lanes or heights, so hypot's overflow guard only costs time.
+                    const double ex = x - scratch.curveX[i];
+                    const double ey = y - scratch.curveY[i];
+                    total += std::sqrt(ex * ex + ey * ey);
+                }
+                if (total < cost[q]) {
+                    cost[q] = total;
+                    from[q] = p;
+                }
+            }
+        }
+    }
+
+    // Walk the least-distance path back from the segment's end, then push it in order.
+    std::vector<char> &keep = scratch.keep;
+    keep.assign(kept, false);
+    std::size_t q = kept - 1;
+    keep[q] = true;
+    while (q != 0) {
+        q = from[q];
+        keep[q] = true;
+    }
+    for (std::size_t j = 0; j < kept; ++j) {
+        if (keep[j]) {
+            PushSegment(scratch, chain, curr, next, candidates[j]);
+        }
+    }
+    candidates.clear();
+}
+
+void Interpolator::VerticalSegment(Scratch &scratch, const mgxc::Chain &chain, const mgxc::Joint &curr,
+                                   const mgxc::Joint &next) {
     const double dT = next.t - curr.t;
     const double dY = next.y - curr.y;
     const int sY = utils::step(dY);
+    const int count = std::abs(next.y - curr.y) + 1;
 
-    mgxc::Joint base = curr;
-    for (int y = curr.y; sY > 0 ? y <= next.y : y >= next.y; y += sY) {
-        const double pY = (y - curr.y) / dY;
-        const double fPY = chain.es.InverseSolve(pY, curr.eY);
+    // Easing parameters of every step of the segment, solved in one batch.
+    scratch.params.resize(count);
+    for (int i = 0; i < count; ++i) {
+        scratch.params[i] = i * sY / dY;
+    }
+    InverseSolve(scratch, chain, scratch.params, scratch.params, curr.eY);
 
-        base.t = utils::iround(curr.t + fPY * dT);
+    mgxc::Joint base = curr;
+    for (int i = 0; i < count; ++i) {
+        base.t = utils::iround(curr.t + scratch.params[i] * dT);
         base.x = curr.x;
-        base.y = y;
+        base.y = curr.y + i * sY;
 
-        PushSegment(chain, curr, next, base);
+        PushStep(scratch, chain, curr, next, base);
+    }
+    if (scratch.optimal) {
+        SampleSegment(scratch, chain, curr, next);
     }
 }
 
-void Interpolator::HorizontalSegment(const mgxc::Chain &chain, const mgxc::Joint &curr, const mgxc::Joint &next) {
+void Interpolator::HorizontalSegment(Scratch &scratch, const mgxc::Chain &chain, const mgxc::Joint &curr,
+                                     const mgxc::Joint &next) {
     const double dT = next.t - curr.t;
     const double dX = next.x - curr.x;
     const double dY = next.y - curr.y;
     const int sX = utils::step(dX);
+    const int count = std::abs(next.x - curr.x) + 1;
 
-    mgxc::Joint base = curr;
-    for (int x = curr.x; sX > 0 ? x <= next.x : x >= next.x; x += sX) {
-        const double pX = (x - curr.x) / dX;
-        const double fPX = chain.es.InverseSolve(pX, curr.eX);
+    // Easing parameters of every step of the segment, solved in one batch: ticks from x, then y from ticks.
+    scratch.params.resize(count);
+    for (int i = 0; i < count; ++i) {
+        scratch.params[i] = i * sX / dX;
+    }
+    InverseSolve(scratch, chain, scratch.params, scratch.params, curr.eX);
 
-        base.t = utils::iround(curr.t + fPX * dT);
-        base.x = x;
+    scratch.solved.resize(count);
+    if (dY != 0) {
+        for (int i = 0; i < count; ++i) {
+            scratch.solved[i] = (utils::iround(curr.t + scratch.params[i] * dT) - curr.t) / dT;
+        }
+        Solve(scratch, chain, scratch.solved, scratch.solved, curr.eY);
+    }
+
+    mgxc::Joint base = curr;
+    for (int i = 0; i < count; ++i) {
+        base.t = utils::iround(curr.t + scratch.params[i] * dT);
+        base.x = curr.x + i * sX;
 
         if (dY != 0) {
-            const double pT = (base.t - curr.t) / dT;
-            const double fPT = chain.es.Solve(pT, curr.eY);
-            base.y = utils::iround(curr.y + fPT * dY);
+            base.y = utils::iround(curr.y + scratch.solved[i] * dY);
         }
 
-        PushSegment(chain, curr, next, base);
+        PushStep(scratch, chain, curr, next, base);
+    }
+    if (scratch.optimal) {
+        SampleSegment(scratch, chain, curr, next);
     }
 }
 
-void Interpolator::InterpolateChain(std::size_t idx) {
-    m_noteChain.clear();
+void Interpolator::Simplify(Scratch &scratch, const mgxc::Chain &chain, const mgxc::Joint &curr,
+                            const mgxc::Joint &next, const std::size_t first, const double tolerance) {
+    std::vector<MP_NOTEINFO> &noteChain = scratch.noteChain;
+    const std::size_t last = noteChain.size() - 1;
+    if (last < first + 2) {
+        return;
+    }
+
+    const int dT = next.t - curr.t;
+
+    std::vector<char> &keep = scratch.keep;
+    keep.assign(last - first + 1, false);
+    keep.front() = keep.back() = true;
+
+    auto &spans = scratch.spans;
+    spans.clear();
+    spans.emplace_back(first, last);
+    while (!spans.empty()) {
+        const auto [a, b] = spans.back();
+        spans.pop_back();
+        if (b < a + 2) {
+            continue;
+        }
+
+        const MP_NOTEINFO &start = noteChain[a];
+        const MP_NOTEINFO &end = noteChain[b];
+        const double length = end.tick - start.tick;
+        // Distance from the straight line between the span's ends, as the rendered curve passes the tick.
+        const auto distance = [&](const int tick, const double x, const double y) {
+            const double f = (tick - start.tick) / length;
+            const double lineX = start.x + f * (end.x - start.x);
+            const double lineY = start.height + f * (end.height - start.height);
+            return std::hypot(x - lineX, y - lineY);
+        };
+
+        // The eased curve over the span's ticks only, solved a batch at a time so a span off the curve stops early.
+        double worst = 0;
+        for (int from = start.tick + 1; from < end.tick && worst <= tolerance; from += SIMPLIFY_BATCH) {
+            const int count = std::min(SIMPLIFY_BATCH, end.tick - from);
+            scratch.params.resize(count);
+            for (int i = 0; i < count; ++i) {
+                scratch.params[i] = static_cast<double>(std::clamp(from + i - curr.t, 0, dT)) / dT;
+            }
+            scratch.curveX.resize(count);
+            scratch.curveY.resize(count);
+            Solve(scratch, chain, scratch.params, scratch.curveX, curr.eX);
+            Solve(scratch, chain, scratch.params, scratch.curveY, curr.eY);
+            for (int i = 0; i < count && worst <= tolerance; ++i) {
+                const double x = curr.x + scratch.curveX[i] * (next.x - curr.x);
+                const double y = curr.y + scratch.curveY[i] * (next.y - curr.y);
+                worst = std::max(worst, distance(from + i, x, y));
+            }
+        }
+        if (worst <= tolerance) {
+            continue;
+        }
+
+        std::size_t split = a + 1;
+        double farthest = -1;
+        for (std::size_t j = a + 1; j < b; ++j) {
+            if (const double d = distance(noteChain[j].tick, noteChain[j].x, noteChain[j].height); d > farthest) {
+                farthest = d;
+                split = j;
+            }
+        }
+        keep[split - first] = true;
+        spans.emplace_back(a, split);
+        spans.emplace_back(split, b);
+    }
+
+    std::size_t kept = first;
+    for (std::size_t j = first; j <= last; ++j) {
+        if (keep[j - first]) {
+            noteChain[kept++] = noteChain[j];
+        }
+    }
+    scratch.dropped += noteChain.size() - kept;
+    noteChain.resize(kept);
+}
+
+void Interpolator::InterpolateChain(const std::size_t idx, Scratch &scratch, std::vector<MP_NOTEINFO> &out) const {
+    scratch.noteChain.clear();
 
     if (idx >= m_cctx.chains.size()) {
         throw std::out_of_range(std::format("Invalid chain index: {}", idx));
@@ -120,9 +466,31 @@ void Interpolator::InterpolateChain(std::size_t idx) {
         throw std::invalid_argument(std::format("Chain [{}] must have at least 2 notes", idx));
     }
 
-    for (std::size_t i = 0; i < chain.size() - 1; ++i) {
-        mgxc::Joint curr = chain[i].Snap(m_cctx.snap);
-        mgxc::Joint next = chain[i + 1].Snap(m_cctx.snap);
+    scratch.table = m_cctx.easingTables ? EasingTable::Get(chain.es) : nullptr;
+    scratch.optimal = m_cctx.optimalSampling;
+    scratch.subticks = std::clamp(m_cctx.snap, 1, SAMPLING_SUBTICKS);
+
+    // Snap every joint once, into a contiguous buffer the segment loop walks in pairs.
+    std::vector<mgxc::Joint> &joints = scratch.joints;
+    joints.resize(chain.size());
+    for (std::size_t i = 0; i < chain.size(); ++i) {
+        joints[i] = chain[i].Snap(m_cctx.snap);
+    }
+
+    // The bound sizes the note chain once, and rejects chains too long to convert before any work is done.
+    std::size_t bound = 1;
+    for (std::size_t i = 0; i + 1 < joints.size(); ++i) {
+        bound += SegmentNotes(joints[i], joints[i + 1]);
+    }
+    if (bound > MAX_CHAIN_NOTES) {
+        throw std::invalid_argument(std::format("Chain [{}] would convert to up to {} notes, more than the limit of {}",
+                                                idx, bound, MAX_CHAIN_NOTES));
+    }
+    scratch.noteChain.reserve(bound);
+
+    for (std::size_t i = 0; i < joints.size() - 1; ++i) {
+        const mgxc::Joint &curr = joints[i];
+        const mgxc::Joint &next = joints[i + 1];
 
         if (curr.t >= next.t) {
             throw std::invalid_argument(
@@ -130,28 +498,35 @@ void Interpolator::InterpolateChain(std::size_t idx) {
                                 i + 1, next.t));
         }
 
+        // The segment starts at the note the last one ended on.
+        const std::size_t first = scratch.noteChain.empty() ? 0 : scratch.noteChain.size() - 1;
         const bool trivX = curr.eX == EasingMode::Linear;
         const bool trivY = curr.eY == EasingMode::Linear;
         const bool sameX = curr.x == next.x;
         const bool sameY = curr.y == next.y;
 
         if ((sameX || trivX) && (sameY || trivY)) {
-            PushSegment(chain, curr, next, curr);
+            PushSegment(scratch, chain, curr, next, curr);
         } else if (sameX) {
-            VerticalSegment(chain, curr, next);
+            VerticalSegment(scratch, chain, curr, next);
         } else {
-            HorizontalSegment(chain, curr, next);
+            HorizontalSegment(scratch, chain, curr, next);
         }
 
-        PushSegment(chain, curr, next, next);
+        PushSegment(scratch, chain, curr, next, next);
+        if (m_cctx.tolerance > 0) {
+            Simplify(scratch, chain, curr, next, first, m_cctx.tolerance);
+        }
     }
 
-    FinalizeChain();
-    m_noteChains.push_back(std::move(m_noteChain));
+    FinalizeChain(scratch);
+    // Copy rather than move, so the scratch buffer keeps its capacity for the worker's next chain.
+    out.assign(scratch.noteChain.begin(), scratch.noteChain.end());
 }
 
-void Interpolator::FinalizeChain() {
-    for (MP_NOTEINFO &note: m_noteChain) {
+void Interpolator::FinalizeChain(Scratch &scratch) const {
+    std::vector<MP_NOTEINFO> &noteChain = scratch.noteChain;
+    for (MP_NOTEINFO &note: noteChain) {
         note.tick *= m_cctx.snap;
         note.tick += m_cctx.tOffset;
         note.x += m_cctx.xOffset;
@@ -161,35 +536,147 @@ void Interpolator::FinalizeChain() {
         }
     }
 
-    m_noteChain.front().longAttr = MP_NOTELONGATTR_BEGIN;
-    m_noteChain.back().longAttr = MP_NOTELONGATTR_END;
+    noteChain.front().longAttr = MP_NOTELONGATTR_BEGIN;
+    noteChain.back().longAttr = MP_NOTELONGATTR_END;
 }
 
-void Print(const std::vector<std::vector<MP_NOTEINFO>> &chains) {
-    std::cout << std::endl << "Interpolated " << chains.size() << std::endl;
-    int i = 0;
-    for (const std::vector<MP_NOTEINFO> &chain: chains) {
-        std::cout << i++ << ":" << std::endl;
-        for (const MP_NOTEINFO &note: chain) {
-            std::cout << "  a=" << note.longAttr << ", t=" << note.tick << ", x=" << note.x << ", h=" << note.height
-                      << std::endl;
+void Interpolator::LogNoteChains(const std::chrono::steady_clock::duration elapsed, const unsigned workers,
+                                 const std::size_t reused) const {
+    std::size_t notes = 0;
+    std::size_t longest = 0;
+    std::size_t shortest = m_noteChains.empty() ? 0 : SIZE_MAX;
+    for (const std::vector<MP_NOTEINFO> &chain: m_noteChains) {
+        notes += chain.size();
+        longest = std::max(longest, chain.size());
+        shortest = std::min(shortest, chain.size());
+    }
+
+    const std::string cached = m_cache ? std::format("; {} reused from cache", reused) : std::string();
+    const std::string simplified =
+            m_cctx.tolerance > 0 ? std::format("; {} control notes dropped within {}", m_dropped, m_cctx.tolerance)
+                                 : std::string();
+    logging::Log<logging::Level::Info>("Interpolated {} chains into {} notes in {:.3f} ms on {} threads; notes per "
+                                       "chain {}..{}{}{}",
+                                       m_noteChains.size(), notes,
+                                       std::chrono::duration<double, std::milli>(elapsed).count(), workers, shortest,
+                                       longest, cached, simplified);
+
+    if (logging::IsEnabled<logging::Level::Trace>()) {
+        for (std::size_t i = 0; i < m_noteChains.size(); ++i) {
+            std::string text = std::format("Note chain {}:", i);
+            for (const MP_NOTEINFO &note: m_noteChains[i]) {
+                std::format_to(std::back_inserter(text), "\n  a={}, t={}, x={}, h={}", note.longAttr, note.tick,
+                               note.x, note.height);
+            }
+            logging::Log<logging::Level::Trace>("{}", text);
         }
     }
 }
 
+void Interpolator::Convert(const int idx) { Convert(idx, {}); }
 
-void Interpolator::Convert(const int idx) {
-    ResetOutput();
+bool Interpolator::Convert(const int idx, const std::stop_token st, std::atomic_size_t *done) {
+    const auto start = std::chrono::steady_clock::now();
 
-    if (idx < 0) {
-        for (size_t i = 0; i < m_cctx.chains.size(); ++i) {
-            InterpolateChain(i);
+    // Chains to convert: the one requested, or all of them.
+    std::size_t first = 0;
+    std::size_t count = m_cctx.chains.size();
+    if (idx >= 0) {
+        first = static_cast<std::size_t>(idx);
+        count = first < m_cctx.chains.size() ? 1 : 0;
+    }
+    PrepareOutput(count);
+
+    // Cache lookups run here on the calling thread; only the misses go to the workers.
+    std::vector<std::uint64_t> &keys = m_keys;
+    std::vector<std::size_t> &pending = m_pending;
+    pending.clear();
+    if (m_cache) {
+        keys.resize(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            keys[i] = ConversionCache::Key(m_cctx.chains[first + i], m_cctx);
+            if (const std::vector<MP_NOTEINFO> *hit = m_cache->Find(keys[i], m_cctx.chains[first + i], m_cctx)) {
+                m_noteChains[i].assign(hit->begin(), hit->end());
+                if (done) {
+                    done->fetch_add(1, std::memory_order_relaxed);
+                }
+            } else {
+                pending.push_back(i);
+            }
+        }
+    } else {
+        for (std::size_t i = 0; i < count; ++i) {
+            pending.push_back(i);
         }
-    } else if (idx < m_cctx.chains.size()) {
-        InterpolateChain(idx);
     }
 
-    Print(m_noteChains);
+    const unsigned workers = static_cast<unsigned>(
+            std::max<std::size_t>(1, std::min<std::size_t>(utils::thread_count(m_cctx.threads), pending.size())));
+    if (m_scratches.size() < workers) {
+        m_scratches.resize(workers);
+    }
+    std::vector<std::exception_ptr> &errors = m_errors;
+    errors.assign(pending.size(), nullptr);
+    for (Scratch &scratch: m_scratches) {
+        scratch.dropped = 0;
+    }
+
+    // Errors are collected per chain, so the reported one does not depend on scheduling.
+    utils::parallel_for(
+            pending.size(),
+            [&](const std::size_t k, const unsigned worker) {
+                if (st.stop_requested()) {
+                    return;
+                }
+                const std::size_t i = pending[k];
+                try {
+                    InterpolateChain(first + i, m_scratches[worker], m_noteChains[i]);
+                } catch (...) {
+                    errors[k] = std::current_exception();
+                }
+                if (done) {
+                    done->fetch_add(1, std::memory_order_relaxed);
+                }
+            },
+            workers);
+
+    if (st.stop_requested()) {
+        ResetOutput();
+        return false;
+    }
+
+    if (const auto error = std::ranges::find_if(errors, [](const std::exception_ptr &e) { return e != nullptr; });
+        error != errors.end()) {
+        ResetOutput();
+        std::rethrow_exception(*error);
+    }
+
+    if (m_cache) {
+        for (const std::size_t i: pending) {
+            m_cache->Store(keys[i], m_cctx.chains[first + i], m_cctx, m_noteChains[i]);
+        }
+        m_cache->EndConversion();
+    }
+
+    m_dropped = 0;
+    for (const Scratch &scratch: m_scratches) {
+        m_dropped += scratch.dropped;
+    }
+
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    if (!pending.empty()) {
+        std::size_t converted = 0;
+        for (const std::size_t i: pending) {
+            converted += m_noteChains[i].size();
+        }
+        const double seconds = std::chrono::duration<double>(elapsed).count();
+        m_throughput = seconds > 0 ? static_cast<double>(converted) / seconds : m_throughput;
+    }
+
+    if (logging::IsEnabled<logging::Level::Info>()) {
+        LogNoteChains(elapsed, workers, count - pending.size());
+    }
+    return true;
 }
 
 void Interpolator::Clamp(MP_NOTEINFO &note) {
@@ -198,65 +685,25 @@ void Interpolator::Clamp(MP_NOTEINFO &note) {
     note.width = std::max(1, std::min(note.width, 16 - note.x));
 }
 
-void Interpolator::Commit(const MargreteHandle &mg) const {
+void Interpolator::Commit(mgxc::ChartWriter &writer) const {
     if (m_noteChains.empty()) {
         return;
     }
 
+    std::size_t notes = 0;
+    for (const std::vector<MP_NOTEINFO> &chain: m_noteChains) {
+        notes += chain.size();
+    }
+
     try {
-        mg.BeginRecording();
-        const MgComPtr<IMargretePluginChart> chart = mg.GetChart();
+        writer.Begin();
+        writer.Reserve(m_noteChains.size(), notes);
         for (const std::vector<MP_NOTEINFO> &chain: m_noteChains) {
-            CommitChain(chart, chain);
+            writer.Write(chain);
         }
-        mg.CommitRecording();
+        writer.Commit();
     } catch (...) {
-        mg.DiscardRecording();
+        writer.Discard();
         throw;
     }
 }
-
-void Interpolator::CommitChain(const MargreteComPtr<IMargretePluginChart> &p_chart,
-                               const std::vector<MP_NOTEINFO> &chain) {
-    const MP_NOTEINFO &airHead = chain.front();
-
-    const MargreteComPtr<IMargretePluginNote> longBegin = CreateNote(p_chart);
-    longBegin->setInfo(&airHead);
-    for (size_t i = 1; i < chain.size(); ++i) {
-        MargreteComPtr<IMargretePluginNote> airControl = CreateNote(p_chart);
-        airControl->setInfo(&chain[i]);
-        longBegin->appendChild(airControl.get());
-    }
-
-    if (airHead.type == MP_NOTETYPE_AIRSLIDE) {
-        MP_NOTEINFO info = airHead;
-        info.type = MP_NOTETYPE_TAP;
-        info.longAttr = MP_NOTELONGATTR_NONE;
-        info.direction = MP_NOTEDIR_NONE;
-
-        const MargreteComPtr<IMargretePluginNote> tap = CreateNote(p_chart);
-        tap->setInfo(&info);
-
-        info.type = MP_NOTETYPE_AIR;
-        info.direction = MP_NOTEDIR_UP;
-
-        const MargreteComPtr<IMargretePluginNote> air = CreateNote(p_chart);
-        air->setInfo(&info);
-
-        air->appendChild(longBegin.get());
-        tap->appendChild(air.get());
-
-        p_chart->appendNote(tap.get());
-    } else {
-        p_chart->appendNote(longBegin.get());
-    }
-}
-
-inline MargreteComPtr<IMargretePluginNote> Interpolator::CreateNote(
-        const MargreteComPtr<IMargretePluginChart> &p_chart) {
-    MargreteComPtr<IMargretePluginNote> note;
-    if (!p_chart->createNote(note.put())) {
-        throw std::runtime_error("Failed to create IMargretePluginNote from IMargretePluginChart");
-    }
-    return note;
-}
@@ -1,68 +1,272 @@
 #pragma once
-#include <MargretePlugin.h>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <span>
+#include <stop_token>
+#include <utility>
 #include <vector>
 
+#include "ChartWriter.h"
 #include "Config.h"
-#include "MargreteHandle.h"
+#include "ConversionCache.h"
+#include "EasingTable.h"
+#include "NoteInfo.h"
 #include "Primitive.h"
 
 /**
  * @class Interpolator
- * @brief Converts chains to note data and commits them to the plugin chart.
+ * @brief Converts chains to note data and commits them to a chart.
  */
 class Interpolator {
 public:
+    /** Most notes one chain may convert to. Chains that could exceed it are rejected before converting. */
+    static constexpr std::size_t MAX_CHAIN_NOTES = 1'000'000;
+    /** Most control notes at one tick that optimal sampling chooses between, nearest the eased curve first. */
+    static constexpr std::size_t SAMPLING_BAND = 4;
+    /** Most points per snapped tick at which optimal sampling measures the curve: every chart tick of finer snaps. */
+    static constexpr int SAMPLING_SUBTICKS = 8;
+    /** Ticks of a span that simplification solves the eased curve at in one batch, before checking the tolerance. */
+    static constexpr int SIMPLIFY_BATCH = 64;
+
+    /**
+     * @struct Estimate
+     * @brief Upper bound on the output of a conversion, computed from the joints without converting.
+     */
+    struct Estimate {
+        std::size_t chains{0}; /**< Number of chains to convert. */
+        std::size_t notes{0}; /**< Most notes the chains convert to. */
+        std::size_t largest{0}; /**< Most notes any one chain converts to. */
+    };
+
     /**
      * @brief Constructs an Interpolator with a reference to the configuration context.
      * @param cctx Reference to the plugin configuration context.
+     * @param cache If not null, conversions reuse the chains it holds and store the chains they convert. Must
+     * outlive the interpolator.
      */
-    explicit Interpolator(Config &cctx);
+    explicit Interpolator(Config &cctx, ConversionCache *cache = nullptr);
 
     /**
      * @brief Converts chains to note data for the specified index or all chains.
+     *
+     * All chains are converted in parallel on Config::threads workers, each with its own scratch buffers.
+     * The output keeps chain order, and if several chains are invalid the error of the first one is thrown.
+     * Buffers and output storage are kept between calls, so a long-lived interpolator converting a chart of the
+     * same shape again allocates nothing.
+     *
      * @param idx Index of the chain to convert, or -1 for all.
      */
     void Convert(int idx = -1);
     /**
-     * @brief Commits the converted note data to the plugin chart.
-     * @param mg MargreteHandle for plugin chart access.
+     * @brief Converts chains like Convert(int), reporting progress and stopping early on request.
+     *
+     * Workers check the stop token before each chain, so a stop takes effect within one chain per worker. A stopped
+     * conversion leaves no output.
+     *
+     * @param idx Index of the chain to convert, or -1 for all.
+     * @param st Stop token of the conversion.
+     * @param done If not null, incremented as each chain finishes.
+     * @return False if the conversion was stopped, otherwise true.
+     */
+    bool Convert(int idx, std::stop_token st, std::atomic_size_t *done = nullptr);
+    /**
+     * @brief Bounds the number of notes a chain converts to.
+     *
+     * A segment adds one note per integer step along the axis it is stepped on, the last step being its end; a
+     * linear segment adds only its end. Notes of a segment have distinct snapped ticks after its start, so no segment
+     * adds more notes than it spans ticks. The bound is exact unless steps round to the same tick.
+     *
+     * @param chain The chain.
+     * @param snap Snap value the chain is converted with.
+     * @return Most notes the chain converts to, or 0 if it has fewer than 2 joints.
+     */
+    static std::size_t EstimateNotes(const mgxc::Chain &chain, MpInteger snap) noexcept;
+    /**
+     * @brief Bounds the output of converting the chain at an index or all chains.
+     * @param cctx Configuration to convert.
+     * @param idx Index of the chain to convert, or -1 for all.
+     * @return The bound.
+     */
+    static Estimate EstimateOutput(const Config &cctx, int idx = -1) noexcept;
+    /**
+     * @brief Gets the speed of the last conversion, counting only the chains it converted rather than reused.
+     * @return Notes per second, or 0 if no chain has been converted yet.
+     */
+    double GetThroughput() const noexcept { return m_throughput; }
+    /**
+     * @brief Gets the number of control notes the last conversion dropped within Config::tolerance.
+     * @return Notes dropped from the chains it converted rather than reused.
      */
-    void Commit(const MargreteHandle &mg) const;
+    std::size_t GetDropped() const noexcept { return m_dropped; }
+    /**
+     * @brief Gets the note chains produced by the last conversion.
+     * @return Note chains in chain order.
+     */
+    const std::vector<std::vector<MP_NOTEINFO>> &GetNoteChains() const noexcept { return m_noteChains; }
+    /**
+     * @brief Commits the converted note data to a chart, discarding every write if one fails.
+     * @param writer Destination of the note chains.
+     */
+    void Commit(mgxc::ChartWriter &writer) const;
 
 private:
     Config &m_cctx; /**< Reference to the plugin configuration context. */
+    ConversionCache *m_cache; /**< Chains converted by earlier conversions, or nullptr. */
 
-    std::vector<std::vector<MP_NOTEINFO>> m_noteChains; /**< Converted note chains. */
-    std::vector<MP_NOTEINFO> m_noteChain; /**< Temporary note chain for conversion. */
+    std::vector<std::vector<MP_NOTEINFO>> m_noteChains; /**< Converted note chains, in chain order. */
+    double m_throughput{0}; /**< Notes per second of the last conversion that converted any chain. */
+    std::size_t m_dropped{0}; /**< Control notes dropped by simplification in the last conversion. */
+    std::vector<std::vector<MP_NOTEINFO>> m_spare; /**< Cleared note chains whose storage the next output reuses. */
 
     /**
-     * @brief Commits a single note chain to the plugin chart.
-     * @param p_chart Plugin chart pointer.
-     * @param chain Note chain to commit.
-     */
-    static void CommitChain(const MargreteComPtr<IMargretePluginChart> &p_chart, const std::vector<MP_NOTEINFO> &chain);
-    /**
-     * @brief Creates a new note in the plugin chart.
-     * @param p_chart Plugin chart pointer.
-     * @return Smart pointer to the created note.
+     * @struct Scratch
+     * @brief Buffers reused across the chains converted by one worker.
      */
-    static MargreteComPtr<IMargretePluginNote> CreateNote(const MargreteComPtr<IMargretePluginChart> &p_chart);
+    struct Scratch {
+        std::vector<MP_NOTEINFO> noteChain; /**< Note chain being converted. */
+        std::vector<mgxc::Joint> joints; /**< Joints of the current chain, snapped. */
+        std::shared_ptr<const EasingTable> table; /**< Easing tables of the current chain, if enabled. */
+        bool optimal{false}; /**< If true, segments collect candidate notes for SampleSegment. */
+        int subticks{1}; /**< Points per snapped tick at which SampleSegment measures the curve. */
+        std::vector<double> params; /**< Easing parameters of the current segment. */
+        std::vector<double> solved; /**< Solved easing values of the current segment. */
+        std::vector<double> curveX; /**< Eased x at the ticks being simplified or sampled. */
+        std::vector<double> curveY; /**< Eased height at the same ticks. */
+        std::vector<char> keep; /**< Whether each note or candidate of the segment is kept. */
+        std::vector<std::pair<std::size_t, std::size_t>> spans; /**< Note spans left to simplify. */
+        std::size_t dropped{0}; /**< Control notes dropped by simplification. */
+        std::vector<mgxc::Joint> candidates; /**< Candidate notes of the segment being sampled, by tick. */
+        std::vector<std::size_t> layers; /**< Index of the first candidate at each tick, and the end. */
+        std::vector<double> cost; /**< Least total distance of the curve up to each candidate. */
+        std::vector<std::size_t> from; /**< Candidate before each one on its least-distance path. */
+    };
+
+    // Kept across conversions, so converting again allocates only where a chart outgrows the last one.
+    std::vector<Scratch> m_scratches; /**< Buffers of each worker. */
+    std::vector<std::uint64_t> m_keys; /**< Cache keys of the chains being converted. */
+    std::vector<std::size_t> m_pending; /**< Chains the cache did not hold. */
+    std::vector<std::exception_ptr> m_errors; /**< Error of each pending chain, if any. */
 
     /**
      * @brief Interpolates a single chain by index.
      * @param idx Index of the chain to interpolate.
+     * @param scratch Buffers of the calling worker.
+     * @param out Receives the note chain.
+     */
+    void InterpolateChain(size_t idx, Scratch &scratch, std::vector<MP_NOTEINFO> &out) const;
+    void FinalizeChain(Scratch &scratch) const;
+    /**
+     * @brief Logs a summary of the converted note chains, and every note at trace level.
+     * @param elapsed Time the conversion took.
+     * @param workers Number of threads the conversion ran on.
+     * @param reused Number of chains taken from the cache.
+     */
+    void LogNoteChains(std::chrono::steady_clock::duration elapsed, unsigned workers, std::size_t reused) const;
+    /**
+     * @brief Empties the output, keeping the storage of its note chains for the next conversion.
      */
-    void InterpolateChain(size_t idx);
-    void FinalizeChain();
     void ResetOutput();
+    /**
+     * @brief Sizes the output to a number of empty note chains, taking their storage from earlier conversions.
+     * @param count Number of note chains.
+     */
+    void PrepareOutput(std::size_t count);
     /**
      * @brief Clamps note values to valid ranges.
      * @param note Note to clamp.
      */
     static void Clamp(MP_NOTEINFO &note);
 
-    void PushSegment(const mgxc::Chain &chain, const mgxc::Joint &curr, const mgxc::Joint &next,
-                     const mgxc::Joint &base);
-    void VerticalSegment(const mgxc::Chain &chain, const mgxc::Joint &curr, const mgxc::Joint &next);
-    void HorizontalSegment(const mgxc::Chain &chain, const mgxc::Joint &curr, const mgxc::Joint &next);
+    /**
+     * @brief Solves a chain's easing function, through its tables if enabled.
+     * @param scratch Buffers of the calling worker.
+     * @param chain The chain.
+     * @param u Input value in [0, 1].
+     * @param mode Easing mode.
+     * @return The eased value.
+     */
+    static double Solve(const Scratch &scratch, const mgxc::Chain &chain, double u, EasingMode mode);
+    /**
+     * @brief Solves a chain's easing function for a batch of inputs, through its tables if enabled.
+     * @param scratch Buffers of the calling worker.
+     * @param chain The chain.
+     * @param u Input values in [0, 1].
+     * @param out Receives the eased values; may alias u.
+     * @param mode Easing mode.
+     */
+    static void Solve(const Scratch &scratch, const mgxc::Chain &chain, std::span<const double> u,
+                      std::span<double> out, EasingMode mode);
+    /**
+     * @brief Inversely solves a chain's easing function for a batch of outputs, through its tables if enabled.
+     * @param scratch Buffers of the calling worker.
+     * @param chain The chain.
+     * @param v Output values in [0, 1].
+     * @param out Receives the input values; may alias v.
+     * @param mode Easing mode.
+     */
+    static void InverseSolve(const Scratch &scratch, const mgxc::Chain &chain, std::span<const double> v,
+                             std::span<double> out, EasingMode mode);
+
+    /**
+     * @brief Bounds the number of notes a segment adds after its start.
+     * @param curr Snapped joint starting the segment.
+     * @param next Snapped joint ending the segment.
+     * @return Most notes the segment adds.
+     */
+    static std::size_t SegmentNotes(const mgxc::Joint &curr, const mgxc::Joint &next) noexcept;
+
+    static void PushSegment(Scratch &scratch, const mgxc::Chain &chain, const mgxc::Joint &curr,
+                            const mgxc::Joint &next, const mgxc::Joint &base);
+    /**
+     * @brief Pushes a stepped note of a segment, or keeps it as a candidate for SampleSegment.
+     * @param scratch Buffers of the calling worker.
+     * @param chain The chain.
+     * @param curr Snapped joint starting the segment.
+     * @param next Snapped joint ending the segment.
+     * @param base The note.
+     */
+    static void PushStep(Scratch &scratch, const mgxc::Chain &chain, const mgxc::Joint &curr, const mgxc::Joint &next,
+                         const mgxc::Joint &base);
+    /**
+     * @brief Pushes the candidate notes of a segment, one per tick, choosing them by dynamic programming.
+     *
+     * Each tick with candidates is a layer of at most SAMPLING_BAND of them, and the segment's joints are the only
+     * candidates of the first and last layers. A path takes one candidate per layer, and costs the distance between the
+     * straight lines the chart draws through it and the eased curve, summed over the chart ticks between snapped ticks
+     * (up to SAMPLING_SUBTICKS per snapped tick). The nearest candidate at each tick is only optimal at the snapped
+     * ticks themselves. The least-cost path is found in one pass over the layers, so the work is linear in the
+     * segment's ticks and candidates.
+     *
+     * @param scratch Buffers of the calling worker; holds the candidates.
+     * @param chain The chain.
+     * @param curr Snapped joint starting the segment.
+     * @param next Snapped joint ending the segment.
+     */
+    static void SampleSegment(Scratch &scratch, const mgxc::Chain &chain, const mgxc::Joint &curr,
+                              const mgxc::Joint &next);
+    static void VerticalSegment(Scratch &scratch, const mgxc::Chain &chain, const mgxc::Joint &curr,
+                                const mgxc::Joint &next);
+    static void HorizontalSegment(Scratch &scratch, const mgxc::Chain &chain, const mgxc::Joint &curr,
+                                  const mgxc::Joint &next);
+    /**
+     * @brief Drops control notes of the segment just converted while the curve stays within a tolerance.
+     *
+     * Douglas-Peucker over the segment's notes: a span of notes is replaced by its two ends if the straight line
+     * between them, as the chart renders it, stays within the tolerance of the eased curve at every tick of the span;
+     * otherwise it is split at the note farthest from that line. Spans with no note between their ends are kept as
+     * converted, so no tick ends up further from the curve than the tolerance or than it was before.
+     *
+     * @param scratch Buffers of the calling worker; its note chain ends with the segment.
+     * @param chain The chain.
+     * @param curr Snapped joint starting the segment.
+     * @param next Snapped joint ending the segment.
+     * @param first Index of the segment's first note.
+     * @param tolerance Largest distance from the curve.
+     */
+    static void Simplify(Scratch &scratch, const mgxc::Chain &chain, const mgxc::Joint &curr, const mgxc::Joint &next,
+                         std::size_t first, double tolerance);
 };
@@ -0,0 +1,3 @@
+#include "MargreteChartWriter.h"
+
+template class mgxc::ComChartWriter<MargreteHandle>;
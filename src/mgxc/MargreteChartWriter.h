@@ -0,0 +1,11 @@
+#pragma once
+
+#include "ComChartWriter.h"
+#include "MargreteHandle.h"
+
+/**
+ * @brief Writes note chains to the chart open in Margrete, as a single undo step.
+ */
+using MargreteChartWriter = mgxc::ComChartWriter<MargreteHandle>;
+
+extern template class mgxc::ComChartWriter<MargreteHandle>;
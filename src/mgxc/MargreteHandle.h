@@ -22,6 +22,10 @@ public:
  */
 class MargreteHandle {
 public:
+    using Note = IMargretePluginNote; /**< Note interface created by the chart. */
+    template<typename T>
+    using ComPtr = MgComPtr<T>; /**< Smart pointer holding the interfaces. */
+
     MargreteHandle(const MargreteHandle &) = delete;
     MargreteHandle &operator=(const MargreteHandle &) = delete;
     /**
@@ -0,0 +1,126 @@
+#include "MockMargrete.h"
+
+#include <stdexcept>
+
+namespace mgxc::mock {
+    void Recorder::Record(std::size_t CallCounts::*method) {
+        ++(m_calls.*method);
+        if (m_latency <= std::chrono::nanoseconds::zero()) {
+            return;
+        }
+
+        // Spin rather than sleep: latencies worth simulating are far below the scheduler's granularity.
+        const auto until = std::chrono::steady_clock::now() + m_latency;
+        while (std::chrono::steady_clock::now() < until) {
+        }
+    }
+
+    void Note::setInfo(const MP_NOTEINFO *info) {
+        m_recorder->Record(&CallCounts::setInfo);
+        m_info = *info;
+    }
+
+    bool Note::appendChild(Note *child) {
+        m_recorder->Record(&CallCounts::appendChild);
+        if (!child || child == this) {
+            return false;
+        }
+        m_children.push_back(child);
+        return true;
+    }
+
+    bool Chart::createNote(Note **note) {
+        m_recorder->Record(&CallCounts::createNote);
+        *note = &m_pool.emplace_back(*m_recorder);
+        return true;
+    }
+
+    bool Chart::appendNote(Note *note) {
+        m_recorder->Record(&CallCounts::appendNote);
+        if (!note) {
+            return false;
+        }
+        m_notes.push_back(note);
+        return true;
+    }
+
+    std::size_t Chart::CountNotes() const {
+        std::size_t count = 0;
+        std::vector<const Note *> pending(m_notes.begin(), m_notes.end());
+        while (!pending.empty()) {
+            const Note *note = pending.back();
+            pending.pop_back();
+            ++count;
+            pending.insert(pending.end(), note->GetChildren().begin(), note->GetChildren().end());
+        }
+        return count;
+    }
+
+    void Chart::Truncate(const std::size_t count) {
+        if (count < m_notes.size()) {
+            m_notes.resize(count);
+        }
+    }
+
+    void Chart::Clear() {
+        m_notes.clear();
+        m_pool.clear();
+    }
+
+    void UndoBuffer::beginRecording() {
+        m_recorder->Record(&CallCounts::beginRecording);
+        m_mark = m_chart->GetNotes().size();
+    }
+
+    void UndoBuffer::commitRecording() {
+        m_recorder->Record(&CallCounts::commitRecording);
+        ++m_steps;
+    }
+
+    void UndoBuffer::discardRecording() {
+        m_recorder->Record(&CallCounts::discardRecording);
+        m_chart->Truncate(m_mark);
+    }
+
+    bool Document::getChart(Chart **chart) {
+        m_recorder->Record(&CallCounts::getChart);
+        *chart = &m_chart;
+        return true;
+    }
+
+    bool Document::getUndoBuffer(UndoBuffer **undo) {
+        *undo = &m_undo;
+        return true;
+    }
+
+    Margrete::Margrete(const std::chrono::nanoseconds latency) : m_recorder(latency), m_doc(m_recorder) {
+        m_doc.getUndoBuffer(&m_undo);
+    }
+
+    Margrete::ComPtr<Chart> Margrete::GetChart() const {
+        ComPtr<Chart> chart;
+        if (!m_doc.getChart(chart.put())) {
+            throw std::runtime_error("Failed to get IMargretePluginChart from IMargretePluginDocument");
+        }
+        return chart;
+    }
+
+    void Margrete::BeginRecording() const {
+        m_undo->beginRecording();
+    }
+
+    void Margrete::CommitRecording() const {
+        m_undo->commitRecording();
+        m_recorder.Record(&CallCounts::update);
+    }
+
+    void Margrete::DiscardRecording() const {
+        m_undo->discardRecording();
+        m_recorder.Record(&CallCounts::update);
+    }
+
+    void Margrete::Reset() {
+        m_doc.GetChartState().Clear();
+        m_recorder.ResetCalls();
+    }
+} // namespace mgxc::mock
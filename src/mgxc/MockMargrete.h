@@ -0,0 +1,295 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+#include "NoteInfo.h"
+
+namespace mgxc::mock {
+    /**
+     * @struct CallCounts
+     * @brief Number of calls made to each plugin interface method.
+     */
+    struct CallCounts {
+        std::size_t getChart{0}; /**< IMargretePluginDocument::getChart. */
+        std::size_t beginRecording{0}; /**< IMargretePluginUndoBuffer::beginRecording. */
+        std::size_t commitRecording{0}; /**< IMargretePluginUndoBuffer::commitRecording. */
+        std::size_t discardRecording{0}; /**< IMargretePluginUndoBuffer::discardRecording. */
+        std::size_t update{0}; /**< IMargretePluginContext::update. */
+        std::size_t createNote{0}; /**< IMargretePluginChart::createNote. */
+        std::size_t appendNote{0}; /**< IMargretePluginChart::appendNote. */
+        std::size_t setInfo{0}; /**< IMargretePluginNote::setInfo. */
+        std::size_t appendChild{0}; /**< IMargretePluginNote::appendChild. */
+
+        /**
+         * @brief Gets the number of calls to any method.
+         * @return Total number of calls.
+         */
+        std::size_t Total() const noexcept {
+            return getChart + beginRecording + commitRecording + discardRecording + update + createNote + appendNote +
+                   setInfo + appendChild;
+        }
+    };
+
+    /**
+     * @class Recorder
+     * @brief Counts calls and makes each one take the simulated latency of crossing into the editor.
+     */
+    class Recorder {
+    public:
+        /**
+         * @brief Constructs a Recorder.
+         * @param latency Time every call takes.
+         */
+        explicit Recorder(std::chrono::nanoseconds latency = {}) : m_latency(latency) {}
+
+        /**
+         * @brief Counts a call and waits for the latency.
+         * @param method Counter of the method called.
+         */
+        void Record(std::size_t CallCounts::*method);
+
+        /**
+         * @brief Gets the calls counted so far.
+         * @return Call counts.
+         */
+        const CallCounts &GetCalls() const noexcept { return m_calls; }
+        /**
+         * @brief Resets every call count to zero.
+         */
+        void ResetCalls() noexcept { m_calls = {}; }
+
+    private:
+        std::chrono::nanoseconds m_latency; /**< Time every call takes. */
+        CallCounts m_calls; /**< Calls counted so far. */
+    };
+
+    /**
+     * @brief Non-owning stand-in for MargreteComPtr. The mock chart owns every object it hands out.
+     * @tparam T Mock interface type.
+     */
+    template<typename T>
+    class ComPtr {
+    public:
+        ComPtr() = default;
+        explicit ComPtr(T *ptr) : m_ptr(ptr) {}
+
+        T *get() const noexcept { return m_ptr; }
+        T **put() noexcept {
+            m_ptr = nullptr;
+            return &m_ptr;
+        }
+        void reset() noexcept { m_ptr = nullptr; }
+        T *operator->() const noexcept { return m_ptr; }
+        explicit operator bool() const noexcept { return m_ptr != nullptr; }
+
+    private:
+        T *m_ptr{nullptr}; /**< The object, or nullptr. */
+    };
+
+    /**
+     * @class Note
+     * @brief Stand-in for IMargretePluginNote that keeps its info and children.
+     */
+    class Note {
+    public:
+        /**
+         * @brief Constructs a Note.
+         * @param recorder Recorder of the owning chart.
+         */
+        explicit Note(Recorder &recorder) : m_recorder(&recorder) {}
+
+        void setInfo(const MP_NOTEINFO *info);
+        bool appendChild(Note *child);
+
+        /**
+         * @brief Gets the info last set.
+         * @return Note info.
+         */
+        const MP_NOTEINFO &GetInfo() const noexcept { return m_info; }
+        /**
+         * @brief Gets the child notes in order of appending.
+         * @return Child notes.
+         */
+        const std::vector<Note *> &GetChildren() const noexcept { return m_children; }
+
+    private:
+        Recorder *m_recorder; /**< Recorder of the owning chart. */
+        MP_NOTEINFO m_info{}; /**< Info last set. */
+        std::vector<Note *> m_children; /**< Child notes. */
+    };
+
+    /**
+     * @class Chart
+     * @brief Stand-in for IMargretePluginChart that records the appended note trees.
+     */
+    class Chart {
+    public:
+        /**
+         * @brief Constructs a Chart.
+         * @param recorder Recorder counting the calls.
+         */
+        explicit Chart(Recorder &recorder) : m_recorder(&recorder) {}
+
+        bool createNote(Note **note);
+        bool appendNote(Note *note);
+
+        /**
+         * @brief Gets the notes appended to the chart, the roots of the note trees.
+         * @return Appended notes in order.
+         */
+        const std::vector<Note *> &GetNotes() const noexcept { return m_notes; }
+        /**
+         * @brief Gets the number of notes in every tree appended to the chart.
+         * @return Number of notes.
+         */
+        std::size_t CountNotes() const;
+        /**
+         * @brief Removes the notes appended after the given count.
+         * @param count Number of appended notes to keep.
+         */
+        void Truncate(std::size_t count);
+        /**
+         * @brief Removes every note, including those created but never appended.
+         */
+        void Clear();
+
+    private:
+        Recorder *m_recorder; /**< Recorder counting the calls. */
+        std::deque<Note> m_pool; /**< Every note created, with stable addresses. */
+        std::vector<Note *> m_notes; /**< Appended notes. */
+    };
+
+    /**
+     * @class UndoBuffer
+     * @brief Stand-in for IMargretePluginUndoBuffer that drops the appended notes of a discarded recording.
+     */
+    class UndoBuffer {
+    public:
+        /**
+         * @brief Constructs an UndoBuffer.
+         * @param recorder Recorder counting the calls.
+         * @param chart Chart the recordings apply to.
+         */
+        UndoBuffer(Recorder &recorder, Chart &chart) : m_recorder(&recorder), m_chart(&chart) {}
+
+        void beginRecording();
+        void commitRecording();
+        void discardRecording();
+
+        /**
+         * @brief Gets the number of recordings committed.
+         * @return Number of undo steps.
+         */
+        std::size_t GetSteps() const noexcept { return m_steps; }
+
+    private:
+        Recorder *m_recorder; /**< Recorder counting the calls. */
+        Chart *m_chart; /**< Chart the recordings apply to. */
+        std::size_t m_mark{0}; /**< Number of appended notes when the recording began. */
+        std::size_t m_steps{0}; /**< Number of recordings committed. */
+    };
+
+    /**
+     * @class Document
+     * @brief Stand-in for IMargretePluginDocument, owning the chart and its undo buffer.
+     */
+    class Document {
+    public:
+        /**
+         * @brief Constructs a Document.
+         * @param recorder Recorder counting the calls.
+         */
+        explicit Document(Recorder &recorder) : m_recorder(&recorder), m_chart(recorder), m_undo(recorder, m_chart) {}
+
+        bool getChart(Chart **chart);
+        bool getUndoBuffer(UndoBuffer **undo);
+
+        /**
+         * @brief Gets the chart without counting a call.
+         * @return The chart.
+         */
+        Chart &GetChartState() noexcept { return m_chart; }
+        /**
+         * @copydoc GetChartState
+         */
+        const Chart &GetChartState() const noexcept { return m_chart; }
+        /**
+         * @brief Gets the undo buffer without counting a call.
+         * @return The undo buffer.
+         */
+        const UndoBuffer &GetUndoState() const noexcept { return m_undo; }
+
+    private:
+        Recorder *m_recorder; /**< Recorder counting the calls. */
+        Chart m_chart; /**< The chart. */
+        UndoBuffer m_undo; /**< The undo buffer. */
+    };
+
+    /**
+     * @class Margrete
+     * @brief In-process stand-in for MargreteHandle, to measure and test chart commits without the editor.
+     *
+     * Every interface call is counted and takes the configured latency, and the committed notes are kept as the
+     * note trees the editor would receive.
+     */
+    class Margrete {
+    public:
+        using Note = mock::Note; /**< Note interface created by the chart. */
+        template<typename T>
+        using ComPtr = mock::ComPtr<T>; /**< Smart pointer holding the interfaces. */
+
+        Margrete(const Margrete &) = delete;
+        Margrete &operator=(const Margrete &) = delete;
+        /**
+         * @brief Constructs a Margrete stand-in.
+         * @param latency Time every interface call takes.
+         */
+        explicit Margrete(std::chrono::nanoseconds latency = {});
+
+        /**
+         * @brief Gets the chart of the document.
+         * @return Pointer to the chart.
+         */
+        ComPtr<Chart> GetChart() const;
+        /**
+         * @brief Begins a recording session for undo/redo.
+         */
+        void BeginRecording() const;
+        /**
+         * @brief Commits the current recording session and refreshes the editor.
+         */
+        void CommitRecording() const;
+        /**
+         * @brief Discards the current recording session and refreshes the editor.
+         */
+        void DiscardRecording() const;
+
+        /**
+         * @brief Gets the calls counted so far.
+         * @return Call counts.
+         */
+        const CallCounts &GetCalls() const noexcept { return m_recorder.GetCalls(); }
+        /**
+         * @brief Gets the chart and its note trees.
+         * @return The chart.
+         */
+        const Chart &GetChartState() const noexcept { return m_doc.GetChartState(); }
+        /**
+         * @brief Gets the number of recordings committed.
+         * @return Number of undo steps.
+         */
+        std::size_t GetUndoSteps() const noexcept { return m_doc.GetUndoState().GetSteps(); }
+        /**
+         * @brief Removes every note and resets the call counts.
+         */
+        void Reset();
+
+    private:
+        mutable Recorder m_recorder; /**< Recorder counting the calls. */
+        mutable Document m_doc; /**< The document. */
+        UndoBuffer *m_undo{nullptr}; /**< Undo buffer of the document. */
+    };
+} // namespace mgxc::mock
@@ -0,0 +1,56 @@
+#include "NoteForest.h"
+
+#include <algorithm>
+
+namespace mgxc {
+    void NoteForest::Reserve(const std::size_t chains, const std::size_t notes) {
+        // Air slides add a tap and an air note, so allow two extra notes per chain.
+        m_notes.reserve(notes + chains * 2);
+        m_parents.reserve(notes + chains * 2);
+        m_bounds.reserve(chains + 1);
+        m_heads.reserve(chains);
+    }
+
+    void NoteForest::Append(const std::span<const MP_NOTEINFO> noteChain) {
+        if (noteChain.empty()) {
+            return;
+        }
+
+        const MP_NOTEINFO &airHead = noteChain.front();
+        std::int32_t head = 0;
+
+        if (airHead.type == MP_NOTETYPE_AIRSLIDE) {
+            MP_NOTEINFO info = airHead;
+            info.type = MP_NOTETYPE_TAP;
+            info.longAttr = MP_NOTELONGATTR_NONE;
+            info.direction = MP_NOTEDIR_NONE;
+            m_notes.push_back(info);
+            m_parents.push_back(ROOT);
+
+            info.type = MP_NOTETYPE_AIR;
+            info.direction = MP_NOTEDIR_UP;
+            m_notes.push_back(info);
+            m_parents.push_back(0);
+
+            m_parents.push_back(1);
+            head = 2;
+        } else {
+            m_parents.push_back(ROOT);
+        }
+
+        m_notes.insert(m_notes.end(), noteChain.begin(), noteChain.end());
+        m_parents.insert(m_parents.end(), noteChain.size() - 1, head);
+
+        m_maxTree = std::max(m_maxTree, m_notes.size() - m_bounds.back());
+        m_bounds.push_back(m_notes.size());
+        m_heads.push_back(static_cast<std::size_t>(head));
+    }
+
+    void NoteForest::Clear() noexcept {
+        m_notes.clear();
+        m_parents.clear();
+        m_bounds.resize(1);
+        m_heads.clear();
+        m_maxTree = 0;
+    }
+} // namespace mgxc
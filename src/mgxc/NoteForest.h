@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "NoteInfo.h"
+
+namespace mgxc {
+    /**
+     * @class NoteForest
+     * @brief Note trees of a commit, laid out as flat arrays ready to be replayed into a chart.
+     *
+     * Each tree is stored top-down: its root first, then every note after its parent, down to the chain head and the
+     * rest of the chain below it. Parents and heads are indices relative to the start of their tree.
+     */
+    class NoteForest {
+    public:
+        static constexpr std::int32_t ROOT = -1; /**< Parent index of a tree root. */
+
+        /**
+         * @brief Reserves storage for a number of chains and notes.
+         * @param chains Number of chains.
+         * @param notes Number of notes in those chains.
+         */
+        void Reserve(std::size_t chains, std::size_t notes);
+        /**
+         * @brief Adds the tree of a note chain.
+         *
+         * The chain head becomes a long note whose children are the rest of the chain. Air slides additionally hang
+         * off a tap and an air note at the head, which make the tree root.
+         *
+         * @param noteChain Notes of the chain, starting with its head. Empty chains add nothing.
+         */
+        void Append(std::span<const MP_NOTEINFO> noteChain);
+        /**
+         * @brief Removes every tree, keeping the storage.
+         */
+        void Clear() noexcept;
+
+        /**
+         * @brief Gets the notes of every tree.
+         * @return Notes, tree by tree.
+         */
+        std::span<const MP_NOTEINFO> GetNotes() const noexcept { return m_notes; }
+        /**
+         * @brief Gets the parent of every note.
+         * @return Parent indices relative to the tree start, or ROOT.
+         */
+        std::span<const std::int32_t> GetParents() const noexcept { return m_parents; }
+        /**
+         * @brief Gets the index of the first note of every tree, followed by the number of notes.
+         * @return Tree boundaries; tree i spans [bounds[i], bounds[i + 1]).
+         */
+        std::span<const std::size_t> GetBounds() const noexcept { return m_bounds; }
+        /**
+         * @brief Gets the position of the chain head in every tree.
+         * @return Head indices relative to the tree start; the notes before the head each hold the next one.
+         */
+        std::span<const std::size_t> GetHeads() const noexcept { return m_heads; }
+        /**
+         * @brief Gets the number of trees.
+         * @return Number of trees.
+         */
+        std::size_t GetTreeCount() const noexcept { return m_bounds.size() - 1; }
+        /**
+         * @brief Gets the number of notes in the largest tree.
+         * @return Size of the largest tree.
+         */
+        std::size_t GetMaxTreeSize() const noexcept { return m_maxTree; }
+
+    private:
+        std::vector<MP_NOTEINFO> m_notes; /**< Notes, tree by tree. */
+        std::vector<std::int32_t> m_parents; /**< Parent of every note, relative to its tree. */
+        std::vector<std::size_t> m_bounds{0}; /**< Start of every tree, then the end of the last. */
+        std::vector<std::size_t> m_heads; /**< Chain head of every tree, relative to its tree. */
+        std::size_t m_maxTree{0}; /**< Number of notes in the largest tree. */
+    };
+} // namespace mgxc
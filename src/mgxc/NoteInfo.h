@@ -0,0 +1,70 @@
+#pragma once
+
+/**
+ * @brief Note data shared by the conversion pipeline and the plugin.
+ *
+ * Builds that can see the Margrete plugin SDK take MP_NOTEINFO and its constants from it, so converted notes go to
+ * the editor as they are. Headless builds use the copy below, which declares only the plain data the pipeline needs
+ * and none of the COM interfaces. Keep it in sync with MargretePlugin.h.
+ */
+#if __has_include(<MargretePlugin.h>)
+#include <MargretePlugin.h>
+#else
+#include <cstdint>
+
+using MpInteger = std::int32_t;
+
+enum MP_NOTETYPE_ : MpInteger {
+    MP_NOTETYPE_UNDEFINED = 0,
+    MP_NOTETYPE_TAP,
+    MP_NOTETYPE_EXTAP,
+    MP_NOTETYPE_FLICK,
+    MP_NOTETYPE_DAMAGE,
+    MP_NOTETYPE_HOLD,
+    MP_NOTETYPE_SLIDE,
+    MP_NOTETYPE_AIR,
+    MP_NOTETYPE_AIRHOLD,
+    MP_NOTETYPE_AIRSLIDE,
+    MP_NOTETYPE_AIRCRUSH,
+};
+
+enum MP_NOTELONGATTR_ : MpInteger {
+    MP_NOTELONGATTR_NONE = 0,
+    MP_NOTELONGATTR_BEGIN,
+    MP_NOTELONGATTR_STEP,
+    MP_NOTELONGATTR_CONTROL,
+    MP_NOTELONGATTR_END,
+};
+
+enum MP_NOTEDIR_ : MpInteger {
+    MP_NOTEDIR_NONE = 0,
+    MP_NOTEDIR_UP,
+    MP_NOTEDIR_DOWN,
+};
+
+enum MP_NOTEEXATTR_ : MpInteger {
+    MP_NOTEEXATTR_NONE = 0,
+};
+
+enum MP_OPTIONVALUE_ : MpInteger {
+    MP_OPTIONVALUE_AIRCRUSH_TRACELIKE = 1,
+};
+
+/**
+ * @struct MP_NOTEINFO
+ * @brief Properties of a single note, as the editor stores them.
+ */
+struct MP_NOTEINFO {
+    MpInteger type; /**< Note type, an MP_NOTETYPE_ value. */
+    MpInteger longAttr; /**< Position in a long note, an MP_NOTELONGATTR_ value. */
+    MpInteger direction; /**< Direction, an MP_NOTEDIR_ value. */
+    MpInteger exAttr; /**< Extra attributes, an MP_NOTEEXATTR_ value. */
+    MpInteger variationId; /**< Variation of the note type. */
+    MpInteger x; /**< Lane of the left edge. */
+    MpInteger width; /**< Width in lanes. */
+    MpInteger height; /**< Height of air notes. */
+    MpInteger tick; /**< Tick position. */
+    MpInteger timelineId; /**< Timeline (TIL) index. */
+    MpInteger optionValue; /**< Type-specific option, such as MP_OPTIONVALUE_AIRCRUSH_TRACELIKE. */
+};
+#endif
@@ -0,0 +1,221 @@
+#include "Primitive.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <format>
+#include <stdexcept>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+namespace mgxc {
+    std::size_t Chain::sort(const std::size_t track) {
+        // The sort is stable, so the joint lands after every earlier tick and after the equal ticks before it.
+        const MpInteger t = joints[track].t;
+        std::size_t rank = 0;
+        for (std::size_t i = 0; i < joints.size(); ++i) {
+            rank += joints[i].t < t || (joints[i].t == t && i < track);
+        }
+
+        const auto byTick = [](const Joint &a, const Joint &b) { return a.t < b.t; };
+        const auto first = joints.begin();
+        const auto moved = first + static_cast<std::ptrdiff_t>(track);
+        const auto last = joints.end();
+        const bool othersSorted = std::is_sorted(first, moved, byTick) && std::is_sorted(moved + 1, last, byTick) &&
+                                  (moved == first || moved + 1 == last || (moved - 1)->t <= (moved + 1)->t);
+        if (!othersSorted) {
+            sort();
+        } else if (rank < track) {
+            std::rotate(first + static_cast<std::ptrdiff_t>(rank), moved, moved + 1);
+        } else if (rank > track) {
+            std::rotate(moved, moved + 1, first + static_cast<std::ptrdiff_t>(rank) + 1);
+        }
+        return rank;
+    }
+
+    std::size_t Chain::Insert(const Joint &joint) {
+        const auto it = std::ranges::upper_bound(joints, joint.t, {}, &Joint::t);
+        return static_cast<std::size_t>(joints.insert(it, joint) - joints.begin());
+    }
+
+    std::size_t Chain::Merge(std::vector<Joint> incoming) {
+        return MergeTracking(std::move(incoming), joints.size()).first;
+    }
+
+    std::size_t Chain::Merge(std::vector<Joint> incoming, const std::size_t track) {
+        return MergeTracking(std::move(incoming), track).second;
+    }
+
+    MpInteger Chain::FindFreeTick(MpInteger tick, const MpInteger step) const {
+        auto it = std::ranges::lower_bound(joints, tick, {}, &Joint::t);
+        while (it != joints.end() && it->t == tick) {
+            tick += step;
+            it = std::ranges::lower_bound(it, joints.end(), tick, {}, &Joint::t);
+        }
+        return tick;
+    }
+
+    std::pair<std::size_t, std::size_t> Chain::MergeTracking(std::vector<Joint> incoming, const std::size_t track) {
+        std::ranges::stable_sort(incoming, {}, &Joint::t);
+
+        std::vector<Joint> merged;
+        merged.reserve(joints.size() + incoming.size());
+        const auto append = [&merged](const Joint &joint) {
+            // Only joints at the same tick can be equal, and they are the last ones merged so far.
+            for (auto it = merged.rbegin(); it != merged.rend() && it->t == joint.t; ++it) {
+                if (*it == joint) {
+                    return;
+                }
+            }
+            merged.push_back(joint);
+        };
+
+        std::size_t tracked = track;
+        auto next = incoming.begin();
+        for (std::size_t i = 0; i <= joints.size(); ++i) {
+            // New joints go after the chain's joints at the same tick, as appending and sorting would place them.
+            while (next != incoming.end() && (i == joints.size() || next->t < joints[i].t)) {
+                append(*next++);
+            }
+            if (i < joints.size()) {
+                if (i == track) {
+                    tracked = merged.size();
+                }
+                merged.push_back(joints[i]);
+            }
+        }
+
+        const std::size_t added = merged.size() - joints.size();
+        joints = std::move(merged);
+        return {added, tracked};
+    }
+} // namespace mgxc
+
+namespace mgxc::data {
+    namespace {
+        /**
+         * @class LineReader
+         * @brief Reads the fields of one line in place, skipping blanks between them as stream extraction does.
+         */
+        class LineReader {
+        public:
+            explicit LineReader(const std::string_view line) noexcept :
+                m_pos(line.data()), m_end(line.data() + line.size()) {}
+
+            bool Expect(const char c) noexcept {
+                char read;
+                return Read(read) && read == c;
+            }
+
+            bool Read(char &value) noexcept {
+                SkipBlanks();
+                if (m_pos == m_end) {
+                    return false;
+                }
+                value = *m_pos++;
+                return true;
+            }
+
+            template<class T>
+            bool Read(T &value) noexcept {
+                SkipBlanks();
+                // Stream extraction accepts an explicit plus sign; from_chars does not.
+                if (m_pos != m_end && *m_pos == '+') {
+                    ++m_pos;
+                }
+                const auto [ptr, ec] = std::from_chars(m_pos, m_end, value);
+                if (ec != std::errc{}) {
+                    return false;
+                }
+                m_pos = ptr;
+                return true;
+            }
+
+        private:
+            const char *m_pos; /**< Next character to read. */
+            const char *m_end; /**< End of the line. */
+
+            void SkipBlanks() noexcept {
+                while (m_pos != m_end && (*m_pos == ' ' || *m_pos == '\t' || *m_pos == '\v' || *m_pos == '\f')) {
+                    ++m_pos;
+                }
+            }
+        };
+
+        bool ParseHeader(const std::string_view line, Chain &chain) noexcept {
+            LineReader reader(line);
+            char kind;
+            if (!(reader.Expect('[') && reader.Read(chain.type) && reader.Expect(',') && reader.Read(chain.width) &&
+                  reader.Expect(',') && reader.Read(chain.til) && reader.Expect(',') && reader.Read(kind) &&
+                  reader.Expect(',') && reader.Read(chain.es.m_param) && reader.Expect(']'))) {
+                return false;
+            }
+            chain.es.m_kind = static_cast<EasingKind>(kind);
+            return true;
+        }
+
+        bool ParseJoint(const std::string_view line, Joint &joint) noexcept {
+            LineReader reader(line);
+            char eX, eY;
+            if (!(reader.Expect('(') && reader.Read(joint.t) && reader.Expect(',') && reader.Read(joint.x) &&
+                  reader.Expect(',') && reader.Read(joint.y) && reader.Expect(',') && reader.Read(eX) &&
+                  reader.Expect(',') && reader.Read(eY) && reader.Expect(')'))) {
+                return false;
+            }
+            joint.eX = static_cast<EasingMode>(eX);
+            joint.eY = static_cast<EasingMode>(eY);
+            return true;
+        }
+    } // namespace
+
+    std::vector<Chain> Parse(const std::string_view text) {
+        std::vector<Chain> chains;
+        Chain chain;
+        bool open = false;
+        bool sorted = true;
+
+        const auto flush = [&] {
+            if (open && !chain.empty()) {
+                if (!sorted) {
+                    chain.sort();
+                }
+                chains.push_back(std::move(chain));
+            }
+            chain = Chain{};
+            open = false;
+            sorted = true;
+        };
+
+        std::size_t number = 0;
+        for (std::size_t pos = 0; pos < text.size();) {
+            const std::size_t eol = std::min(text.find('\n', pos), text.size());
+            std::string_view line = text.substr(pos, eol - pos);
+            pos = eol + 1;
+            ++number;
+            if (line.ends_with('\r')) {
+                line.remove_suffix(1);
+            }
+
+            if (line.empty()) {
+                flush();
+            } else if (line.front() == '[') {
+                flush();
+                if (!ParseHeader(line, chain)) {
+                    throw std::invalid_argument(std::format("Invalid header format at line {}: {}", number, line));
+                }
+                open = true;
+            } else if (open) {
+                Joint joint;
+                if (!ParseJoint(line, joint)) {
+                    throw std::invalid_argument(std::format("Invalid body format at line {}: {}", number, line));
+                }
+                sorted = sorted && (chain.empty() || chain.back().t <= joint.t);
+                chain.push_back(joint);
+            }
+        }
+        flush();
+
+        return chains;
+    }
+} // namespace mgxc::data
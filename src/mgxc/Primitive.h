@@ -1,15 +1,17 @@
 #pragma once
 
 #include <algorithm>
-#include <atomic>
 #include <format>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
 #include <vector>
 
-#include <MargretePlugin.h>
-
 #include "Easing.h"
+#include "NoteInfo.h"
 #include "Utils.h"
 
 namespace mgxc {
@@ -21,12 +23,17 @@ namespace mgxc {
      * @brief Number of ticks in a beat.
      */
     constexpr MpInteger BEAT_TICKS = BAR_TICKS / 4;
+    /**
+     * @brief Highest timeline (TIL) index.
+     */
+    constexpr MpInteger MAX_TIL = 15;
 
     /**
      * @class Joint
      * @brief Represents a note/control point in a chain.
      *
-     * Stores timing, position, and easing information for a single point.
+     * Stores timing, position, and easing information for a single point. Trivially copyable and free of shared
+     * state, so snapped copies on the conversion path cost no more than the five fields they hold.
      */
     class Joint {
     public:
@@ -75,16 +82,6 @@ namespace mgxc {
             const int sT = utils::iround(static_cast<double>(t) / snap);
             return Joint{sT, x, y, eX, eY};
         }
-
-        /**
-         * @brief Gets the unique ID of the Joint.
-         * @return The unique ID.
-         */
-        std::size_t GetID() const noexcept { return id; }
-
-    private:
-        inline static std::atomic_size_t nextId{0}; /**< Static counter for unique IDs. */
-        std::size_t id{nextId++}; /**< Unique ID for this Joint. */
     };
 
     class Chain {
@@ -124,6 +121,57 @@ namespace mgxc {
         void sort() {
             std::ranges::stable_sort(joints, [](const Joint &a, const Joint &b) { return a.t < b.t; });
         }
+
+        /**
+         * @brief Sorts the joints by tick, keeping track of one of them.
+         *
+         * When only the tracked joint is out of place, as after appending or retiming it, it is moved into place
+         * without sorting the rest.
+         *
+         * @param track Index of the joint to follow.
+         * @return Index of that joint after sorting.
+         */
+        std::size_t sort(std::size_t track);
+
+        /**
+         * @brief Inserts a joint after every joint at or before its tick, as appending and sorting would.
+         * @param joint The joint.
+         * @return Index of the inserted joint.
+         */
+        std::size_t Insert(const Joint &joint);
+
+        /**
+         * @brief Merges joints into the sorted chain, skipping those equal to a joint already in it.
+         *
+         * Joints are compared by tick and position. The result matches appending the new joints one at a time, skipping
+         * duplicates, and then sorting, but takes a single pass over the chain after sorting the new joints.
+         *
+         * @param incoming Joints to merge, in any order.
+         * @return Number of joints added.
+         */
+        std::size_t Merge(std::vector<Joint> incoming);
+
+        /**
+         * @brief Merges joints into the sorted chain, keeping track of one of its joints.
+         * @param incoming Joints to merge, in any order.
+         * @param track Index of the joint to follow.
+         * @return Index of that joint after merging.
+         */
+        std::size_t Merge(std::vector<Joint> incoming, std::size_t track);
+
+        /**
+         * @brief Finds the first tick, stepping from a start tick, that no joint of the sorted chain is at.
+         * @param tick Tick to start from.
+         * @param step Positive distance between candidate ticks.
+         * @return The free tick.
+         */
+        MpInteger FindFreeTick(MpInteger tick, MpInteger step) const;
+
+    private:
+        /**
+         * @brief Merges joints, returning the number added and the tracked joint's index after merging.
+         */
+        std::pair<std::size_t, std::size_t> MergeTracking(std::vector<Joint> incoming, std::size_t track);
     };
 
 } // namespace mgxc
@@ -164,78 +212,54 @@ namespace mgxc::data {
         return oss.str();
     }
 
-    inline std::vector<Chain> Parse(const std::string &text) {
-        std::vector<Chain> chains;
-        std::vector<std::string> buf;
-        std::istringstream in{text};
-
-        const auto flush = [&] {
-            if (buf.empty()) {
-                return;
-            }
-
-            Chain chain;
-
-            {
-                std::istringstream hd(buf.front());
-                char bL, c1, c2, c3, c4, bR;
-                char eK;
-                if (!(hd >> bL >> chain.type >> c1 >> chain.width >> c2 >> chain.til >> c3 >> eK >> c4 >>
-                      chain.es.m_param >> bR)) {
-                    throw std::invalid_argument("Invalid header format: " + buf.front());
-                }
-                if (bL != '[' || c1 != ',' || c2 != ',' || c3 != ',' || c4 != ',' || bR != ']') {
-                    throw std::invalid_argument("Invalid header format: " + buf.front());
-                }
-                chain.es.m_kind = static_cast<EasingKind>(eK);
-            }
+    inline std::string Serialize(const MP_NOTEINFO &n) {
+        return std::format("{{{},{},{},{},{}}}\n", n.tick, n.x, n.width, n.height, n.longAttr);
+    }
 
-            for (std::size_t i = 1; i < buf.size(); ++i) {
-                if (buf[i].empty()) {
-                    continue;
-                }
-
-                int t, x, y;
-                char eX, eY;
-                {
-                    std::istringstream bd(buf[i]);
-                    char pL, c1, c2, c3, c4, pR;
-                    if (!(bd >> pL >> t >> c1 >> x >> c2 >> y >> c3 >> eX >> c4 >> eY >> pR)) {
-                        throw std::invalid_argument("Invalid body format: " + buf[i]);
-                    }
-                    if (pL != '(' || c1 != ',' || c2 != ',' || c3 != ',' || c4 != ',' || pR != ')') {
-                        throw std::invalid_argument("Invalid body format: " + buf[i]);
-                    }
-                }
-
-                chain.emplace_back(t, x, y, static_cast<EasingMode>(eX), static_cast<EasingMode>(eY));
-            }
+    /**
+     * @brief Serializes a note chain as a <type,til> header followed by one {tick,x,width,height,longAttr} line per
+     * note. The format is write-only: note chains are rebuilt by converting their chains again.
+     * @param noteChain Note chain produced by Interpolator.
+     * @return The serialized note chain, or an empty string if it has no notes.
+     */
+    inline std::string Serialize(const std::vector<MP_NOTEINFO> &noteChain) {
+        if (noteChain.empty()) {
+            return {};
+        }
 
-            if (!chain.empty()) {
-                chain.sort();
-                chains.push_back(std::move(chain));
-            }
+        std::ostringstream oss;
 
-            buf.clear();
-        };
+        const MP_NOTEINFO &head = noteChain.front();
+        oss << std::format("<{},{}>\n", head.type, head.timelineId);
 
-        std::string line;
-        while (std::getline(in, line)) {
-            if (line.empty()) {
-                flush();
-                continue;
-            }
+        for (const MP_NOTEINFO &n: noteChain) {
+            oss << Serialize(n);
+        }
+        return oss.str();
+    }
 
-            if (!line.empty() && line.front() == '[') {
-                flush();
-                buf.push_back(std::move(line));
-            } else if (!buf.empty()) {
-                buf.push_back(std::move(line));
+    inline std::string Serialize(const std::vector<std::vector<MP_NOTEINFO>> &noteChains) {
+        std::ostringstream oss;
+        for (const std::vector<MP_NOTEINFO> &c: noteChains) {
+            if (&c != &noteChains.front()) {
+                oss << "\n";
             }
+            oss << Serialize(c);
         }
-        flush();
-
-        return chains;
+        return oss.str();
     }
 
+    /**
+     * @brief Parses chains from the text Serialize writes.
+     *
+     * Each chain is a [type,width,til,kind,param] header line followed by one (t,x,y,eX,eY) line per joint, and ends
+     * at an empty line or the next header. Lines before the first header are ignored, as are chains without joints.
+     * Lines are parsed in place as the text is scanned; a chain is sorted by tick only if its joints are out of order.
+     *
+     * @param text The text; lines may end in \n or \r\n.
+     * @return The chains, with their joints sorted by tick.
+     * @throws std::invalid_argument naming the line number of the first malformed header or joint line.
+     */
+    std::vector<Chain> Parse(std::string_view text);
+
 } // namespace mgxc::data